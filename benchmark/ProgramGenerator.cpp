@@ -0,0 +1,97 @@
+#include <algorithm>
+#include <cctype>
+#include <set>
+#include <stdexcept>
+#include "ProgramGenerator.h"
+
+namespace {
+    // enough walks to find every short keyword and punctuation of usual rules
+    constexpr int WALKS_COUNT = 200000;
+    constexpr std::size_t MAX_LEXEME_LENGTH = 16;
+    constexpr std::size_t MAX_LEXEMES_PER_GROUP = 4096;
+}
+
+ProgramGenerator::ProgramGenerator(const CompiledDFA &dfa, const GeneratorOptions &options) {
+    this->options = options;
+    this->random.seed(options.seed);
+    this->sample_lexemes(dfa);
+    for (int c = 0; c < 256; c++) {
+        if (dfa.next(dfa.get_start(), (unsigned char) c) == CompiledDFA::INVALID && std::isgraph(c)) {
+            this->invalid_bytes.push_back((char) c);
+        }
+    }
+}
+
+void ProgramGenerator::sample_lexemes(const CompiledDFA &dfa) {
+    // the bytes every state can go on with
+    std::vector<std::vector<unsigned char>> moves(dfa.get_states_count());
+    for (int32_t state = 0; state < dfa.get_states_count(); state++) {
+        for (int c = 0; c < 256; c++) {
+            if (dfa.next(state, (unsigned char) c) >= 0) {
+                moves[state].push_back((unsigned char) c);
+            }
+        }
+    }
+
+    std::set<std::string> groups[3]{};
+    std::uniform_real_distribution<double> coin(0, 1);
+    for (int walk = 0; walk < WALKS_COUNT; walk++) {
+        int32_t state = dfa.get_start();
+        std::string lexeme{};
+        while (lexeme.size() < MAX_LEXEME_LENGTH && !moves[state].empty()) {
+            unsigned char c = moves[state][this->random() % moves[state].size()];
+            lexeme += (char) c;
+            state = dfa.next(state, c);
+            if (dfa.get_accept_kind(state) != CompiledDFA::NO_TOKEN && coin(this->random) < 0.3) {
+                auto first = static_cast<unsigned char>(lexeme[0]);
+                int group = std::isalpha(first) ? 0 : std::isdigit(first) ? 1 : 2;
+                if (groups[group].size() < MAX_LEXEMES_PER_GROUP) {
+                    groups[group].insert(lexeme);
+                }
+                break;
+            }
+        }
+    }
+    this->identifiers.assign(groups[0].begin(), groups[0].end());
+    this->numbers.assign(groups[1].begin(), groups[1].end());
+    this->punctuation.assign(groups[2].begin(), groups[2].end());
+    if (this->identifiers.empty() && this->numbers.empty() && this->punctuation.empty()) {
+        throw std::runtime_error("The rules don't accept any lexeme to generate a program from");
+    }
+}
+
+void ProgramGenerator::write(std::ostream &out) {
+    // a group without lexemes is never picked
+    double weights[3] = {
+            this->identifiers.empty() ? 0 : this->options.identifiers,
+            this->numbers.empty() ? 0 : this->options.numbers,
+            this->punctuation.empty() ? 0 : this->options.punctuation,
+    };
+    if (weights[0] + weights[1] + weights[2] <= 0) {
+        throw std::runtime_error("The token mix has no lexeme to pick from");
+    }
+    std::discrete_distribution<int> group_of(weights, weights + 3);
+    std::uniform_real_distribution<double> coin(0, 1);
+    const std::vector<std::string> *groups[3] = {&this->identifiers, &this->numbers, &this->punctuation};
+
+    // written a block at a time, so a 1 GB program never sits in memory
+    std::string block{};
+    std::size_t written = 0;
+    std::size_t tokens_on_line = 0;
+    while (written < this->options.size) {
+        block.clear();
+        while (block.size() < (1 << 16)) {
+            if (!this->invalid_bytes.empty() && coin(this->random) < this->options.error_rate) {
+                block += this->invalid_bytes[this->random() % this->invalid_bytes.size()];
+            } else {
+                const std::vector<std::string> &group = *groups[group_of(this->random)];
+                block += group[this->random() % group.size()];
+            }
+            // about ten tokens on a line
+            block += (++tokens_on_line % 10 == 0) ? '\n' : ' ';
+        }
+        std::size_t count = std::min(block.size(), this->options.size - written);
+        out.write(block.data(), (std::streamsize) count);
+        written += count;
+    }
+}
@@ -0,0 +1,55 @@
+#ifndef COMPILER_PROJECT_PROGRAMGENERATOR_H
+#define COMPILER_PROJECT_PROGRAMGENERATOR_H
+
+
+#include <cstdint>
+#include <ostream>
+#include <random>
+#include <string>
+#include <vector>
+#include "../phase_one/prediction/CompiledDFA.h"
+
+/**
+ * The shape of a synthetic program: its size, the mix of its tokens and how often an invalid character shows up.
+ */
+struct GeneratorOptions {
+    std::size_t size{1 << 20};
+    // the weights of the three groups of tokens (they don't have to add up to 1)
+    double identifiers{0.5};
+    double numbers{0.2};
+    double punctuation{0.3};
+    // the probability that a token is replaced by an invalid character
+    double error_rate{0};
+    uint64_t seed{1};
+};
+
+/**
+ * This class writes synthetic programs for the lexical rules of a compiled DFA.
+ * Lexemes are sampled by random walks from the start state that stop on accepting states, so every lexeme is a
+ * token of the rules whatever they are. They are grouped by their first character: identifiers (and keywords)
+ * start with a letter, numbers with a digit, and everything else is punctuation.
+ */
+class ProgramGenerator {
+public:
+    ProgramGenerator(const CompiledDFA &dfa, const GeneratorOptions &options);
+
+    /**
+     * Writes options.size bytes of tokens separated by white spaces.
+     */
+    void write(std::ostream &out);
+
+private:
+    GeneratorOptions options{};
+    std::mt19937_64 random{};
+    std::vector<std::string> identifiers{};
+    std::vector<std::string> numbers{};
+    std::vector<std::string> punctuation{};
+    // the bytes no token can start with
+    std::vector<char> invalid_bytes{};
+
+    // fills the three groups of lexemes
+    void sample_lexemes(const CompiledDFA &dfa);
+};
+
+
+#endif
@@ -0,0 +1,390 @@
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include "../phase_one/creation/LexicalRulesHandler.h"
+#include "../phase_one/generation/GeneratedScanner.h"
+#include "../phase_one/prediction/InterleavedScanner.h"
+#include "../phase_one/prediction/PipelinedTokenStream.h"
+#include "../phase_one/prediction/Predictor.h"
+#include "../phase_one/prediction/StreamScanner.h"
+#include "ProgramGenerator.h"
+
+/**
+ * Lexer throughput benchmark: generates a synthetic program from the lexical rules, runs every scanner mode on it
+ * several times and prints the results as JSON on the standard output.
+ */
+
+namespace {
+    struct BenchmarkOptions {
+        std::string rules_path{BENCH_DEFAULT_RULES_PATH};
+        GeneratorOptions generator{};
+        int repeat{5};
+        unsigned int threads{4};
+        // the programs the interleaved mode scans together, each one generated with its own seed
+        std::size_t lanes{4};
+        std::vector<std::string> modes{"next_token", "tokenize_all", "tokenize_parallel", "stream", "pipelined",
+                                       "interleaved", "generated"};
+        // where the program is written, a temporary file if empty
+        std::string program_path{};
+        // the training program of LexicalRulesHandler::layout_hot_states ("program" for the generated one),
+        // no layout if empty
+        std::string layout_path{};
+    };
+
+    void print_usage(const char *name) {
+        std::cerr << "Usage: " << name << " [--rules path] [--size 64M] [--identifiers 0.5] [--numbers 0.2]"
+                  << " [--punctuation 0.3] [--error-rate 0] [--seed 1] [--repeat 5] [--threads 4] [--lanes 4]"
+                  << " [--modes next_token,tokenize_all,tokenize_parallel,stream,pipelined,interleaved,generated]"
+                  << " [--program path] [--layout training_path|program]\n";
+    }
+
+    // "64M" -> 64 << 20, accepts K, M and G
+    std::size_t parse_size(const std::string &text) {
+        std::size_t end = 0;
+        double value = std::stod(text, &end);
+        std::string suffix = text.substr(end);
+        if (suffix == "K" || suffix == "k") {
+            value *= 1 << 10;
+        } else if (suffix == "M" || suffix == "m") {
+            value *= 1 << 20;
+        } else if (suffix == "G" || suffix == "g") {
+            value *= 1 << 30;
+        } else if (!suffix.empty()) {
+            throw std::runtime_error("Unknown size suffix: " + text);
+        }
+        return (std::size_t) value;
+    }
+
+    std::vector<std::string> split(const std::string &text, char separator) {
+        std::vector<std::string> parts{};
+        std::stringstream stream(text);
+        std::string part{};
+        while (std::getline(stream, part, separator)) {
+            if (!part.empty()) {
+                parts.push_back(part);
+            }
+        }
+        return parts;
+    }
+
+    BenchmarkOptions parse_options(int argc, char *argv[]) {
+        BenchmarkOptions options{};
+        for (int i = 1; i < argc; i++) {
+            std::string key = argv[i];
+            if (i + 1 >= argc) {
+                throw std::runtime_error("Missing value of " + key);
+            }
+            std::string value = argv[++i];
+            if (key == "--rules") {
+                options.rules_path = value;
+            } else if (key == "--size") {
+                options.generator.size = parse_size(value);
+            } else if (key == "--identifiers") {
+                options.generator.identifiers = std::stod(value);
+            } else if (key == "--numbers") {
+                options.generator.numbers = std::stod(value);
+            } else if (key == "--punctuation") {
+                options.generator.punctuation = std::stod(value);
+            } else if (key == "--error-rate") {
+                options.generator.error_rate = std::stod(value);
+            } else if (key == "--seed") {
+                options.generator.seed = std::stoull(value);
+            } else if (key == "--repeat") {
+                options.repeat = std::max(1, std::stoi(value));
+            } else if (key == "--threads") {
+                options.threads = std::max(1, std::stoi(value));
+            } else if (key == "--lanes") {
+                options.lanes = std::max(1, std::stoi(value));
+            } else if (key == "--modes") {
+                options.modes = split(value, ',');
+            } else if (key == "--program") {
+                options.program_path = value;
+            } else if (key == "--layout") {
+                options.layout_path = value;
+            } else {
+                throw std::runtime_error("Unknown option: " + key);
+            }
+        }
+        return options;
+    }
+
+    // escapes the quotes and back slashes of a JSON string
+    std::string json_string(const std::string &text) {
+        std::string escaped = "\"";
+        for (char c: text) {
+            if (c == '"' || c == '\\') {
+                escaped += '\\';
+            }
+            escaped += c;
+        }
+        return escaped + "\"";
+    }
+
+    // the runs of one mode
+    struct ModeRuns {
+        std::size_t tokens{};
+        std::vector<double> runs{};
+        // the peak resident set size of the process that ran the mode, in KiB
+        long peak_rss_kb{};
+    };
+
+    // whether the scanner compiled into Generated_Scanner is the one of the rules
+    bool generated_scanner_matches(const Lexer &lexer) {
+        if (GeneratedScanner::get_kinds_count() != lexer.get_dfa().get_kinds_count()) {
+            return false;
+        }
+        for (int32_t kind = 0; kind < GeneratedScanner::get_kinds_count(); kind++) {
+            if (GeneratedScanner::get_kind_name(kind) != lexer.get_kind_name(kind)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // runs one mode over the program (the first one, the interleaved mode scans them all),
+    // returns the number of tokens of the program
+    std::size_t run_mode(const std::string &mode, const std::shared_ptr<const Lexer> &lexer,
+                         const std::vector<std::string> &program_paths, unsigned int threads, double &milliseconds) {
+        const std::string &program_path = program_paths.front();
+        std::size_t tokens = 0;
+        // the bytes scanned over the bytes of the program
+        double scanned_programs = 1;
+        auto start = std::chrono::steady_clock::now();
+        if (mode == "stream") {
+            // the stream reads the file as it scans, so reading is part of the time
+            std::ifstream in(program_path, std::ios::binary);
+            StreamScanner scanner(lexer, in);
+            start = std::chrono::steady_clock::now();
+            Token token{};
+            while (scanner.next_token(token)) {
+                tokens++;
+            }
+        } else if (mode == "interleaved") {
+            // the programs are different, so the lanes don't read the same bytes in lockstep
+            std::vector<std::unique_ptr<SourceBuffer>> sources{};
+            std::vector<std::string_view> texts{};
+            std::size_t bytes = 0;
+            for (const std::string &path: program_paths) {
+                sources.push_back(std::make_unique<SourceBuffer>(path));
+                texts.push_back(sources.back()->view());
+                bytes += texts.back().size();
+            }
+            start = std::chrono::steady_clock::now();
+            tokens = InterleavedScanner(lexer, texts.size()).tokenize_all(texts).front().size();
+            // the programs are scanned together, the time of the program is the time of all over their bytes
+            scanned_programs = (double) bytes / (double) std::max<std::size_t>(texts.front().size(), 1);
+        } else {
+            // the program is mapped before the clock starts, the other modes only scan
+            std::shared_ptr<Predictor> predictor = std::make_shared<Predictor>(lexer, program_path);
+            start = std::chrono::steady_clock::now();
+            Token token{};
+            if (mode == "next_token") {
+                while (predictor->next_token(token)) {
+                    tokens++;
+                }
+            } else if (mode == "tokenize_all") {
+                tokens = predictor->tokenize_all().size();
+            } else if (mode == "tokenize_parallel") {
+                tokens = predictor->tokenize_parallel(threads).size();
+            } else if (mode == "pipelined") {
+                PipelinedTokenStream pipeline(predictor);
+                while (pipeline.next_token(token)) {
+                    tokens++;
+                }
+            } else if (mode == "generated") {
+                tokens = GeneratedScanner::tokenize_all(predictor->get_program()).size();
+            } else {
+                throw std::runtime_error("Unknown mode: " + mode);
+            }
+        }
+        milliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count()
+                       / scanned_programs;
+        return tokens;
+    }
+
+    // runs the repeats of a mode in a child process, the peak RSS of a process only grows, so the peak of the child
+    // is the one of the mode alone (and of the pages it shares with the benchmark, the lexer and its table)
+    ModeRuns run_mode_in_child(const std::string &mode, const std::shared_ptr<const Lexer> &lexer,
+                               const std::vector<std::string> &program_paths, unsigned int threads, int repeat) {
+        int fds[2];
+        if (pipe(fds) != 0) {
+            throw std::runtime_error("Failed to create a pipe for mode " + mode);
+        }
+        pid_t pid = fork();
+        if (pid < 0) {
+            throw std::runtime_error("Failed to fork for mode " + mode);
+        }
+        if (pid == 0) {
+            // the child sends the number of tokens and the time of every run
+            close(fds[0]);
+            int status = 0;
+            try {
+                std::vector<double> results(repeat + 1);
+                for (int run = 0; run < repeat; run++) {
+                    std::size_t tokens = run_mode(mode, lexer, program_paths, threads, results[run + 1]);
+                    results[0] = (double) tokens;
+                }
+                std::size_t size = results.size() * sizeof(double);
+                if (write(fds[1], results.data(), size) != (ssize_t) size) {
+                    status = 1;
+                }
+            } catch (const std::exception &e) {
+                std::cerr << e.what() << '\n';
+                status = 1;
+            }
+            close(fds[1]);
+            _exit(status);
+        }
+
+        close(fds[1]);
+        std::vector<double> results(repeat + 1);
+        auto *bytes = reinterpret_cast<char *>(results.data());
+        std::size_t size = results.size() * sizeof(double);
+        std::size_t received = 0;
+        while (received < size) {
+            ssize_t count = read(fds[0], bytes + received, size - received);
+            if (count <= 0) {
+                break;
+            }
+            received += count;
+        }
+        close(fds[0]);
+        int status = 0;
+        struct rusage usage{};
+        wait4(pid, &status, 0, &usage);
+        if (received < size || !WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+            throw std::runtime_error("Mode failed: " + mode);
+        }
+        ModeRuns mode_runs{};
+        mode_runs.tokens = (std::size_t) results[0];
+        mode_runs.runs.assign(results.begin() + 1, results.end());
+        mode_runs.peak_rss_kb = usage.ru_maxrss;
+        return mode_runs;
+    }
+}
+
+int main(int argc, char *argv[]) {
+    BenchmarkOptions options{};
+    try {
+        options = parse_options(argc, argv);
+    } catch (const std::exception &e) {
+        std::cerr << e.what() << '\n';
+        print_usage(argv[0]);
+        return 1;
+    }
+
+    // build the final DFA from the rules like the compiler does
+    std::filesystem::path temporary_directory = std::filesystem::temp_directory_path();
+    std::string pid = std::to_string(getpid());
+    std::string final_dfa_path = (temporary_directory / ("bench_lexer_dfa_" + pid + ".txt")).string();
+    LexicalRulesHandler handler{};
+    std::unordered_map<std::string, std::shared_ptr<Automaton>> automata = handler.handleFile(options.rules_path);
+    std::vector<std::shared_ptr<Automaton>> vector_automata{};
+    for (const auto &pair: automata) {
+        vector_automata.push_back(pair.second);
+    }
+    std::shared_ptr<Automaton> final_dfa = handler.export_automata(vector_automata, final_dfa_path);
+    std::shared_ptr<Automaton> automaton = Automaton::import_from_file(final_dfa_path);
+    std::shared_ptr<const Lexer> lexer = std::make_shared<const Lexer>(automaton);
+
+    // generate the program
+    bool temporary_program = options.program_path.empty();
+    if (temporary_program) {
+        options.program_path = (temporary_directory / ("bench_lexer_program_" + pid + ".txt")).string();
+    }
+    {
+        std::ofstream out(options.program_path, std::ios::binary);
+        if (!out) {
+            std::cerr << "Failed to open file: " << options.program_path << '\n';
+            return 1;
+        }
+        ProgramGenerator(lexer->get_dfa(), options.generator).write(out);
+    }
+    // the other programs of the interleaved lanes, with the next seeds
+    std::vector<std::string> program_paths{options.program_path};
+    if (std::find(options.modes.begin(), options.modes.end(), "interleaved") != options.modes.end()) {
+        for (std::size_t lane = 1; lane < options.lanes; lane++) {
+            std::string path = (temporary_directory / ("bench_lexer_program_" + pid + "_" + std::to_string(lane)
+                                                       + ".txt")).string();
+            GeneratorOptions generator = options.generator;
+            generator.seed += lane;
+            std::ofstream out(path, std::ios::binary);
+            if (!out) {
+                std::cerr << "Failed to open file: " << path << '\n';
+                return 1;
+            }
+            ProgramGenerator(lexer->get_dfa(), generator).write(out);
+            program_paths.push_back(path);
+        }
+    }
+
+    if (!options.layout_path.empty()) {
+        // order the states by the training program, then load the dfa again like the compiler does
+        SourceBuffer training_program(options.layout_path == "program" ? options.program_path : options.layout_path);
+        LexicalRulesHandler::layout_hot_states(final_dfa, training_program.view());
+        final_dfa->export_to_file(final_dfa_path);
+        automaton = Automaton::import_from_file(final_dfa_path);
+        lexer = std::make_shared<const Lexer>(automaton);
+    }
+    std::filesystem::remove(final_dfa_path);
+
+    std::ostringstream json{};
+    json << "{\n";
+    json << "  \"rules\": " << json_string(options.rules_path) << ",\n";
+    json << "  \"size_bytes\": " << options.generator.size << ",\n";
+    json << "  \"mix\": {\"identifiers\": " << options.generator.identifiers << ", \"numbers\": "
+         << options.generator.numbers << ", \"punctuation\": " << options.generator.punctuation << "},\n";
+    json << "  \"error_rate\": " << options.generator.error_rate << ",\n";
+    json << "  \"seed\": " << options.generator.seed << ",\n";
+    json << "  \"repeat\": " << options.repeat << ",\n";
+    json << "  \"threads\": " << options.threads << ",\n";
+    json << "  \"lanes\": " << options.lanes << ",\n";
+    json << "  \"layout\": " << json_string(options.layout_path) << ",\n";
+    json << "  \"dfa\": {\"states\": " << lexer->get_dfa().get_states_count() << ", \"classes\": "
+         << lexer->get_dfa().get_classes_count() << ", \"state_bytes\": " << lexer->get_dfa().get_state_bytes()
+         << ", \"table_bytes\": " << lexer->get_dfa().get_table_size_bytes()
+         << ", \"shuffle_scanner\": " << (lexer->uses_shuffle_scanner() ? "true" : "false") << "},\n";
+    json << "  \"modes\": [";
+    bool first_mode = true;
+    for (const std::string &mode: options.modes) {
+        if (mode == "generated" && !generated_scanner_matches(*lexer)) {
+            std::cerr << "Skipping the generated mode, Generated_Scanner was built from other rules\n";
+            continue;
+        }
+        ModeRuns mode_runs = run_mode_in_child(mode, lexer, program_paths, options.threads, options.repeat);
+        const std::vector<double> &runs = mode_runs.runs;
+        std::size_t tokens = mode_runs.tokens;
+        std::vector<double> sorted_runs = runs;
+        std::sort(sorted_runs.begin(), sorted_runs.end());
+        double best = std::max(sorted_runs.front(), 1e-6);
+        double median = sorted_runs[sorted_runs.size() / 2];
+
+        json << (first_mode ? "\n" : ",\n");
+        first_mode = false;
+        json << "    {\"mode\": \"" << mode << "\", \"tokens\": " << tokens << ", \"runs_ms\": [";
+        for (std::size_t i = 0; i < runs.size(); i++) {
+            json << (i == 0 ? "" : ", ") << runs[i];
+        }
+        json << "], \"best_ms\": " << best << ", \"median_ms\": " << median
+             << ", \"mb_per_s\": " << (double) options.generator.size / (1 << 20) / (best / 1000)
+             << ", \"tokens_per_s\": " << (double) tokens / (best / 1000)
+             << ", \"ns_per_token\": " << (tokens == 0 ? 0 : best * 1e6 / (double) tokens)
+             << ", \"peak_rss_kb\": " << mode_runs.peak_rss_kb << "}";
+    }
+    json << "\n  ]\n}\n";
+    std::cout << json.str();
+
+    if (temporary_program) {
+        std::filesystem::remove(options.program_path);
+    }
+    for (std::size_t lane = 1; lane < program_paths.size(); lane++) {
+        std::filesystem::remove(program_paths[lane]);
+    }
+    return 0;
+}
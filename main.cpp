@@ -7,7 +7,10 @@
 #include "phase_one/creation/InfixToPostfix.h"
 #include "phase_one/creation/ToAutomaton.h"
 #include "phase_one/creation/LexicalRulesHandler.h"
+#include "phase_one/prediction/BatchTokenizer.h"
 #include "phase_one/prediction/Predictor.h"
+#include "phase_one/prediction/PipelinedTokenStream.h"
+#include "phase_one/prediction/StreamScanner.h"
 #include "phase_two/Table.h"
 #include "phase_two/Parser.h"
 
@@ -20,15 +23,31 @@ std::string parsing_table_name = "parsing_table.txt";
 std::string parsing_output_name = "parsing_output.txt";
 
 std::shared_ptr<Automaton>
-init(const std::string &input_file_path, const std::string &final_dfa_path, const std::string &tokens_priorities);
+init(const std::string &input_file_path, const std::string &final_dfa_path, const std::string &tokens_priorities,
+     const std::string &training_program_path = "");
 
-void export_token_list_to_file(const std::vector<std::pair<std::string, std::string>> &token_list,
+void export_token_list_to_file(const TokenBuffer &token_list, const Predictor &predictor,
                                const std::string &filename);
 
+void print_diagnostics(const Diagnostics &diagnostics, TokenStream &tokens, std::string_view program);
+
+int run_batch(int argc, char *argv[]);
+
 int main(int argc, char *argv[]) {
+    // std::cin gets a buffer of its own, so a StreamScanner over it takes the bytes a pipe already has at once
+    std::ios::sync_with_stdio(false);
+    if (argc > 1 && std::string(argv[1]) == "--batch") {
+        return run_batch(argc, argv);
+    }
     if (argc < 4) {
         std::cerr << "Usage: " << argv[0]
                   << " <output_token_path> <input_program_path> <input_rules_path> <input_cfg_path>\n";// <data_directory_path>\n";
+        std::cerr << "Use - as the input program path to scan the program from the standard input as it comes.\n";
+        std::cerr << "Add --pipeline after the paths to scan the program on its own thread while it is parsed.\n";
+        std::cerr << "Add --layout <training_program_path> after the paths to order the states of the DFA by how "
+                     "often the scanner visits them on that program.\n";
+        std::cerr << "Or: " << argv[0]
+                  << " --batch <input_rules_path> <file_list_path> <output_directory> [threads] [lanes]\n";
         return 1;
     }
     // ############################## create export lexical data ##############################
@@ -39,6 +58,15 @@ int main(int argc, char *argv[]) {
     std::string input_program_path = argv[2];
     std::string input_rules_path = argv[3];
     std::string input_cfg_path = argv[4];
+    bool pipeline = false;
+    std::string training_program_path{};
+    for (int i = 5; i < argc; i++) {
+        if (std::string(argv[i]) == "--pipeline") {
+            pipeline = true;
+        } else if (std::string(argv[i]) == "--layout" && i + 1 < argc) {
+            training_program_path = argv[++i];
+        }
+    }
     std::string final_dfa_path = data_directory_path + final_dfa_file_name;
     std::string tokens_priorities_path = data_directory_path + tokens_priorities_name;
     std::string parsing_tree_path = data_directory_path + parsing_tree_name;
@@ -48,48 +76,57 @@ int main(int argc, char *argv[]) {
 
 
     // init the DFA of rules and export its detains and priorities to ../data/final_dfa.txt and ../data/tokens_priorities.txt
-    std::shared_ptr<Automaton> final_dfa = init(input_rules_path, final_dfa_path, tokens_priorities_path);
+    std::shared_ptr<Automaton> final_dfa = init(input_rules_path, final_dfa_path, tokens_priorities_path,
+                                                training_program_path);
 
     // ############################## load lexical data ##############################
 
     // import final automaton (NFA form)
     std::shared_ptr<Automaton> loaded_automaton = Automaton::import_from_file(final_dfa_path);
-    // import tokens priorities
-    std::map<std::string, int> priorities = LexicalRulesHandler::import_priorities(tokens_priorities_path);
+    // the tokens priorities were resolved into the final automaton when it was exported
 
     // ############################## predicting tokens and parsing ##############################
-    if (true) {
-        std::shared_ptr<Predictor> tokenizer = std::make_shared<Predictor>(loaded_automaton, priorities,
-                                                                           input_program_path);
+    if (input_program_path == "-") {
+        // stream the program from the standard input, the parser gets the first tokens before the input is done
+        std::shared_ptr<StreamScanner> tokenizer = std::make_shared<StreamScanner>(loaded_automaton, std::cin);
         std::shared_ptr<Table> parsing_table = std::make_shared<Table>(input_cfg_path, parsing_table_path);
         std::shared_ptr<Parser> parser = std::make_shared<Parser>(parsing_table);
         parser->parse(tokenizer, parsing_tree_path, parsing_output_path);
+        print_diagnostics(tokenizer->get_diagnostics(), *tokenizer, {});
+    }
+    else if (true) {
+        std::shared_ptr<Predictor> tokenizer = std::make_shared<Predictor>(loaded_automaton, input_program_path);
+        std::shared_ptr<Table> parsing_table = std::make_shared<Table>(input_cfg_path, parsing_table_path);
+        std::shared_ptr<Parser> parser = std::make_shared<Parser>(parsing_table);
+        std::shared_ptr<TokenStream> tokens = tokenizer;
+        if (pipeline) {
+            // the scanner runs ahead of the parser on another thread
+            tokens = std::make_shared<PipelinedTokenStream>(tokenizer);
+        }
+        parser->parse(tokens, parsing_tree_path, parsing_output_path);
+        // a pipeline stops its scanner thread here, before the diagnostics are read
+        tokens.reset();
+        print_diagnostics(tokenizer->get_diagnostics(), *tokenizer, tokenizer->get_program());
     }
     else {
         // prediction
-        Predictor predictor(loaded_automaton, priorities, input_program_path);
+        std::shared_ptr<Predictor> predictor = std::make_shared<Predictor>(loaded_automaton, input_program_path);
 
-        std::vector<std::pair<std::string, std::string >> token_list{};
-        std::vector<std::string> tokens{};
         // ############################## predict tokens ##############################
+        TokenBuffer token_list = predictor->tokenize_all();
         std::cout << "############################ Tokens ############################" << '\n';
-        while (true) {
-            std::pair<std::string, std::string> entry = predictor.next_token();
-            if (entry.first.empty() && entry.second.empty()) {
-                // if output is ("","") then we reached the end
-                break;
-            }
-            std::cout << entry.first << ": " << entry.second << std::endl;
-            token_list.push_back(entry);
-            tokens.push_back(entry.first);
+        for (std::size_t i = 0; i < token_list.size(); i++) {
+            Token token = token_list.at(i);
+            std::cout << predictor->get_kind_name(token.kind) << ": " << predictor->get_lexeme(token) << std::endl;
         }
-        export_token_list_to_file(token_list, output_token_path);
+        print_diagnostics(token_list.diagnostics, *predictor, predictor->get_program());
+        export_token_list_to_file(token_list, *predictor, output_token_path);
         std::cout << "########################################################" << '\n';
 
         // ############################## load parser data ##############################
         std::shared_ptr<Table> table = std::make_shared<Table>(input_cfg_path, parsing_table_path);
         std::shared_ptr<Parser> parser = std::make_shared<Parser>(table);
-        parser->parse(tokens);
+        parser->parse(token_list, predictor);
 
         // ############################## end ##############################
     }
@@ -99,7 +136,8 @@ int main(int argc, char *argv[]) {
 }
 
 std::shared_ptr<Automaton>
-init(const std::string &input_file_path, const std::string &final_dfa_path, const std::string &tokens_priorities) {
+init(const std::string &input_file_path, const std::string &final_dfa_path, const std::string &tokens_priorities,
+     const std::string &training_program_path) {
     // ############################## create export automata data ##############################
     // map of a token and the minimized DFA that can define it.
     std::unordered_map<std::string, std::shared_ptr<Automaton>> automata = handler.handleFile(input_file_path);
@@ -110,23 +148,87 @@ init(const std::string &input_file_path, const std::string &final_dfa_path, cons
     }
     // export final automaton (union all: DFAs --union--> NFA --subset construction--> DFA (no minimization))
     std::shared_ptr<Automaton> final_dfa = handler.export_automata(vector_automata, final_dfa_path);
+    if (!training_program_path.empty()) {
+        // put the states the scanner visits the most on the training program first, then export the dfa again
+        SourceBuffer training_program(training_program_path);
+        LexicalRulesHandler::layout_hot_states(final_dfa, training_program.view());
+        final_dfa->export_to_file(final_dfa_path);
+    }
     // export the priorities of tokens
     LexicalRulesHandler::export_priorities(handler.get_priorities(), tokens_priorities);
     return final_dfa;
 }
 
 
-void export_token_list_to_file(const std::vector<std::pair<std::string, std::string>> &token_list,
+void export_token_list_to_file(const TokenBuffer &token_list, const Predictor &predictor,
                                const std::string &filename) {
     std::ofstream outfile(filename);
     if (!outfile) {
         throw std::runtime_error("Failed to open file: " + filename);
     }
 
-    for (const auto &pair: token_list) {
-        outfile << pair.first << '\n';
+    for (int32_t kind: token_list.kinds) {
+        outfile << predictor.get_kind_name(kind) << '\n';
     }
 
     outfile.close();
 }
 
+void print_diagnostics(const Diagnostics &diagnostics, TokenStream &tokens, std::string_view program) {
+    for (const Diagnostic &record: diagnostics.records) {
+        std::cout << "\033[1;31mError: Invalid input\033[0m" << ", ignoring characters";
+        SourcePosition position = tokens.get_position(record.offset);
+        if (position.line != 0) {
+            std::cout << " at line " << position.line << ", column " << position.column;
+        } else {
+            std::cout << " at offset " << record.offset;
+        }
+        if (program.empty()) {
+            // the program was streamed, its bytes are gone
+            std::cout << " (" << record.length << " characters)" << '\n';
+        } else {
+            std::cout << ":'" << program.substr(record.offset, record.length) << "'" << '\n';
+        }
+    }
+    if (!diagnostics.empty()) {
+        std::cout << "\033[1;31mError: Invalid input\033[0m, ignored " << diagnostics.invalid_count << " characters in "
+                  << diagnostics.size() << " places" << std::endl;
+    }
+}
+
+int run_batch(int argc, char *argv[]) {
+    if (argc < 5) {
+        std::cerr << "Usage: " << argv[0]
+                  << " --batch <input_rules_path> <file_list_path> <output_directory> [threads] [lanes]\n";
+        return 1;
+    }
+    std::string data_directory_path = R"(../data/)";
+    std::string input_rules_path = argv[2];
+    std::string file_list_path = argv[3];
+    std::string output_directory = argv[4];
+    unsigned int threads = argc > 5 ? (unsigned int) std::stoul(argv[5]) : 0;
+    // the files every thread scans at once, interleaved
+    std::size_t lanes = argc > 6 ? std::stoul(argv[6]) : 1;
+
+    // the lexer is built and loaded once, then shared by all the workers
+    init(input_rules_path, data_directory_path + final_dfa_file_name, data_directory_path + tokens_priorities_name);
+    std::shared_ptr<Automaton> loaded_automaton =
+            Automaton::import_from_file(data_directory_path + final_dfa_file_name);
+    std::shared_ptr<const Lexer> lexer = std::make_shared<const Lexer>(loaded_automaton);
+
+    BatchTokenizer batch_tokenizer(lexer, threads, lanes);
+    BatchStatistics statistics = batch_tokenizer.run(BatchTokenizer::read_file_list(file_list_path), output_directory);
+    for (const FileStatistics &file: statistics.files) {
+        if (!file.error.empty()) {
+            std::cout << "\033[1;31mError: \033[0m" << file.input_path << ": " << file.error << '\n';
+        } else if (file.invalid_characters > 0) {
+            std::cout << "\033[1;31mError: Invalid input\033[0m in " << file.input_path << ", ignored "
+                      << file.invalid_characters << " characters" << '\n';
+        }
+    }
+    std::cout << "files: " << statistics.files.size() << " (" << statistics.failed_files << " failed)"
+              << ", bytes: " << statistics.bytes << ", tokens: " << statistics.tokens
+              << ", invalid characters: " << statistics.invalid_characters
+              << ", time: " << statistics.milliseconds << " ms" << std::endl;
+    return statistics.failed_files == 0 ? 0 : 1;
+}
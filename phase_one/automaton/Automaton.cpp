@@ -317,7 +317,7 @@ std::string Automaton::to_string() {
 
     ss << "Input Symbols: ";
     for (const auto &symbol: this->alphabets) {
-        ss << symbol << " ";
+        ss << encode_symbol(symbol) << " ";
     }
     ss << "\n";
 
@@ -343,7 +343,7 @@ std::string Automaton::to_string() {
 
 
     for (const auto &entry: sorted_transitions) {
-        ss << "f(" << entry.first.first->getId() << ", " << entry.first.second << ") = ";
+        ss << "f(" << entry.first.first->getId() << ", " << encode_symbol(entry.first.second) << ") = ";
         for (const auto &state: entry.second) {
             ss << state->getId() << " ";
         }
@@ -356,9 +356,16 @@ std::string Automaton::to_string() {
     // add the token
     ss << "Tokens: " << this->get_tokens_string() << "\n";
     for (const auto &pair: this->tokens) {
+        // the token of the state goes first, import_from_file reads it back as the token of the state
         ss << pair.first->toString() << ": ";
+        std::string state_token = pair.first->getToken();
+        if (pair.second.find(state_token) != pair.second.end()) {
+            ss << state_token << " ";
+        }
         for (const auto &str: pair.second) {
-            ss << str << " ";
+            if (str != state_token) {
+                ss << str << " ";
+            }
         }
         ss << '\n';
     }
@@ -482,7 +489,7 @@ std::shared_ptr<Automaton> Automaton::import_from_file(const std::string &filena
 
                 // Add each symbol to the automaton
                 for (const auto &symbol: symbols) {
-                    automaton->add_alphabet(symbol);
+                    automaton->add_alphabet(decode_symbol(symbol));
                 }
             }
 
@@ -531,7 +538,7 @@ std::shared_ptr<Automaton> Automaton::import_from_file(const std::string &filena
                     if (std::regex_search(line, match, re) && match.size() > 3) {
                         // Extract the fromState, symbol, and toState
                         int fromStateID = std::stoi(match.str(1));
-                        std::string symbol = match.str(2);
+                        std::string symbol = decode_symbol(match.str(2));
                         int toStateID = std::stoi(match.str(3));
 
                         // Get the fromState and toState pointers
@@ -631,3 +638,28 @@ std::vector<std::vector<std::shared_ptr<State>>> Automaton::matrix_representatio
     return matrix;
 }
 
+
+std::string Automaton::encode_symbol(const std::string &symbol) {
+    if (symbol.size() != 1) {
+        return symbol;
+    }
+    auto c = static_cast<unsigned char>(symbol.front());
+    if (c > ' ' && c != 0x7F) {
+        return symbol;
+    }
+    // white spaces and control bytes would break the lines and the fields of the file
+    std::ostringstream ss;
+    ss << std::hex << "\\u{" << (int) c << "}";
+    return ss.str();
+}
+
+std::string Automaton::decode_symbol(const std::string &symbol) {
+    if (symbol.size() < 5 || symbol.size() > 6 || symbol.compare(0, 3, "\\u{") != 0 || symbol.back() != '}') {
+        return symbol;
+    }
+    std::string hex = symbol.substr(3, symbol.size() - 4);
+    if (hex.find_first_not_of("0123456789abcdefABCDEF") != std::string::npos) {
+        throw std::runtime_error("Invalid symbol in automaton file: " + symbol);
+    }
+    return std::string(1, static_cast<char>(std::stoi(hex, nullptr, 16)));
+}
@@ -43,7 +43,12 @@ private:
 
 
 public:
+    // The symbols that enter a lexer mode start with this prefix, they are never read from the input
+    // (see LexicalRulesHandler::export_automata).
+    static inline const std::string MODE_SYMBOL_PREFIX = "%mode:";
 
+    // The lexer mode a scanner starts in.
+    static inline const std::string INITIAL_MODE = "INITIAL";
 
     // Default constructor.
     Automaton();
@@ -157,6 +162,12 @@ public:
 
     static std::shared_ptr<Automaton> import_from_file(const std::string &filename);
 
+    // The symbol as it is written in the exported file, white spaces and control bytes are written \u{hex}.
+    static std::string encode_symbol(const std::string &symbol);
+
+    // The symbol written by encode_symbol.
+    static std::string decode_symbol(const std::string &symbol);
+
     std::vector<std::vector<std::shared_ptr<State>>> matrix_representation();
 
 };
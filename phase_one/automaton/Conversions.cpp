@@ -1,6 +1,7 @@
 #include <stack>
 #include <algorithm>
 #include <queue>
+#include <map>
 #include "Conversions.h"
 #include "Utilities.h"
 
@@ -147,6 +148,9 @@ std::shared_ptr<State> Conversions::get_dfa_state(Types::state_set_t &state_set,
 
     prepareForAutomaton(a);
 
+    // alphabets that behave the same way in every state share one computation of the reachable set
+    std::unordered_map<std::string, std::vector<std::string>> alphabet_classes = get_alphabet_classes(a);
+
     // Compute the epsilon closure of the start state
     Types::state_set_t start_set = epsilonClosure(a, a->get_start());
     queue.push(start_set);
@@ -175,7 +179,8 @@ std::shared_ptr<State> Conversions::get_dfa_state(Types::state_set_t &state_set,
         // loop on the alphabets to get the next (from the perspective of the current_set) set
         // of compatible groups of states, and then add transitions to them
         for (const std::basic_string<char> &alphabet: a->get_alphabets()) {
-            if (alphabet != a->get_epsilon_symbol()) {
+            auto alphabet_class = alphabet_classes.find(alphabet);
+            if (alphabet != a->get_epsilon_symbol() && alphabet_class != alphabet_classes.end()) {
                 // get the set reachable from current_set(dfa_state) using current alphabet.
                 Types::state_set_t immediate_reachable_set{};
                 for (const std::shared_ptr<State> &state_ptr: current_set) { // currentSet is already an epsilon closure
@@ -206,7 +211,10 @@ std::shared_ptr<State> Conversions::get_dfa_state(Types::state_set_t &state_set,
                 }
                 // next_state calculated and dfa adjusted to accommodate it, then add the transition
                 // we have a current_state(dfa_state) --alphabet--> fully_reachable_set(next_state)
-                dfa->add_transitions(dfa_state, alphabet, {next_state});
+                // the same transition holds for every alphabet of the class
+                for (const std::string &equivalent_alphabet: alphabet_class->second) {
+                    dfa->add_transitions(dfa_state, equivalent_alphabet, {next_state});
+                }
                 // keep the following code in its order
                 if (new_next_state_created) {
                     queue.push(fully_reachable_set);
@@ -250,6 +258,42 @@ std::shared_ptr<State> Conversions::get_dfa_state(Types::state_set_t &state_set,
     return dfa;
 }
 
+std::unordered_map<std::string, std::vector<std::string>>
+Conversions::get_alphabet_classes(std::shared_ptr<Automaton> &a) {
+    // the signature of an alphabet is every (from state id, sorted next states ids) it is used in
+    using signature_t = std::vector<std::pair<int, std::vector<int>>>;
+    std::unordered_map<std::string, signature_t> signatures{};
+    for (const auto &entry: a->get_transitions()) {
+        if (entry.first.second == a->get_epsilon_symbol() || entry.second.empty()) {
+            continue;
+        }
+        std::vector<int> next_ids{};
+        for (const std::shared_ptr<State> &state_ptr: entry.second) {
+            next_ids.push_back(state_ptr->getId());
+        }
+        std::sort(next_ids.begin(), next_ids.end());
+        signatures[entry.first.second].emplace_back(entry.first.first->getId(), next_ids);
+    }
+
+    std::map<signature_t, std::string> representatives{};
+    std::unordered_map<std::string, std::vector<std::string>> classes{};
+    for (const std::string &alphabet: a->get_alphabets()) {
+        if (alphabet == a->get_epsilon_symbol()) {
+            continue;
+        }
+        signature_t &signature = signatures[alphabet];
+        std::sort(signature.begin(), signature.end());
+        auto it = representatives.find(signature);
+        if (it == representatives.end()) {
+            representatives.emplace(signature, alphabet);
+            classes[alphabet].push_back(alphabet);
+        } else {
+            classes[it->second].push_back(alphabet);
+        }
+    }
+    return classes;
+}
+
 [[maybe_unused]] std::shared_ptr<Automaton> Conversions::minimizeDFA(std::shared_ptr<Automaton> &automaton) {
     // Step 0: Create a copy of the original automaton because it might encounter change.
     std::shared_ptr<Automaton> dfa = Utilities::copyAutomaton(automaton);
@@ -304,12 +348,13 @@ std::vector<Types::state_set_t> Conversions::get_next_equivalence(std::vector<Ty
     for (Types::state_set_t &previous_set: previous_group) {
         // in the new groups variable we are storing the next the collective next paired with the states they came from
         // mapping representatives sets to the group of sets they are being mapped into
-        std::vector<std::pair<Types::state_set_t, Types::state_set_t>> mapping_previous_set_to_next_set;
+        std::vector<std::pair<std::vector<std::shared_ptr<State>>, Types::state_set_t>> mapping_previous_set_to_next_set;
 
         for (const std::shared_ptr<State> &previous_state_ptr: previous_set) {
             // destinations contains the states that are the first state (representative state) in the destination set of the current set
-            // that all in the previous group till now.
-            Types::state_set_t destinations{};
+            // that all in the previous group till now, one for every alphabet in the order of the alphabets: two states
+            // that reach the same sets using different alphabets aren't equivalent.
+            std::vector<std::shared_ptr<State>> destinations{};
 
             for (const std::basic_string<char> &alphabet: dfa->get_alphabets()) {
                 // get the next state of the current state we are on
@@ -318,7 +363,7 @@ std::vector<Types::state_set_t> Conversions::get_next_equivalence(std::vector<Ty
                     // if a set from the previous group contains the next_state_ptr of the set from the same previous group
                     if (temp_previous_set.find(next_state_ptr) != temp_previous_set.end()) {
                         // add to destinations
-                        destinations.insert(*temp_previous_set.begin());
+                        destinations.push_back(*temp_previous_set.begin());
                         break;
                     }
                 }
@@ -327,8 +372,9 @@ std::vector<Types::state_set_t> Conversions::get_next_equivalence(std::vector<Ty
             // next we have to see if another state could have mapped to the same set of representatives
             // now add state to be one of the sources of the destinations calculated above.
             auto it = std::find_if(mapping_previous_set_to_next_set.begin(), mapping_previous_set_to_next_set.end(),
-                                   [&destinations](const std::pair<Types::state_set_t, Types::state_set_t> &entry) {
-                                       return Utilities::set_equal(destinations, entry.first);
+                                   [&destinations](const std::pair<std::vector<std::shared_ptr<State>>,
+                                           Types::state_set_t> &entry) {
+                                       return destinations == entry.first;
                                    });
 
             if (it == mapping_previous_set_to_next_set.end()) {
@@ -341,7 +387,8 @@ std::vector<Types::state_set_t> Conversions::get_next_equivalence(std::vector<Ty
             }
         }
         // now we collect the states sharing the same representatives
-        for (std::pair<Types::state_set_t, Types::state_set_t> &entry: mapping_previous_set_to_next_set) {
+        for (std::pair<std::vector<std::shared_ptr<State>>, Types::state_set_t> &entry:
+                mapping_previous_set_to_next_set) {
             next_group.push_back(entry.second);
         }
     }
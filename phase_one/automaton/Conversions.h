@@ -171,6 +171,20 @@ private:
                                             std::shared_ptr<Automaton> &dfa);
 
 
+    /**
+     * @brief Groups the alphabets of an automaton into equivalence classes.
+     *
+     * @param a A shared pointer to the automaton object.
+     *
+     * @return A map from the representative of every class to all the alphabets of the class (representative included).
+     *
+     * Two alphabets are equivalent if every state of the automaton goes to the same set of states using either of them,
+     * so the subset construction only needs to compute the reachable set once per class.
+     * The representative of a class is its first alphabet in the iteration order of a->get_alphabets().
+     */
+    static std::unordered_map<std::string, std::vector<std::string>>
+    get_alphabet_classes(std::shared_ptr<Automaton> &a);
+
     static std::vector<Types::state_set_t>
     get_next_equivalence(std::vector<Types::state_set_t> &entry, std::shared_ptr<Automaton> &dfa);
 
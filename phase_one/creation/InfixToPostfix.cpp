@@ -2,6 +2,7 @@
 #include <utility>
 #include <stdexcept>
 #include "InfixToPostfix.h"
+#include "Utf8Ranges.h"
 
 InfixToPostfix::InfixToPostfix() : constants() {}
 
@@ -10,7 +11,14 @@ std::vector<std::string> InfixToPostfix::tokenize(const std::string &regular_def
     tokens.reserve(regular_definition.length());  // Reserve space for tokens
     std::string buffer;
     for (char c: regular_definition) {
-        if (!constants.is_operator(c) && !std::isspace(c)) {
+        if (Utf8Ranges::is_placeholder(c)) {
+            // a Unicode character or range, it is never part of a name
+            if (!buffer.empty()) {
+                tokens.push_back(buffer);
+                buffer.clear();
+            }
+            tokens.emplace_back(1, c);
+        } else if (!constants.is_operator(c) && !std::isspace(c)) {
             buffer.push_back(c);
         } else {
             if (!buffer.empty()) {
@@ -1,9 +1,12 @@
 #include "LexicalRulesHandler.h"
 #include "../automaton/Utilities.h"
+#include "../prediction/Lexer.h"
 #include <fstream>
 #include <sstream>
 #include <algorithm>
 #include <queue>
+#include <limits>
+#include <stdexcept>
 
 
 LexicalRulesHandler::LexicalRulesHandler() = default;
@@ -47,8 +50,18 @@ std::map<std::string, int> LexicalRulesHandler::get_priorities() {
 
 std::shared_ptr<Automaton> LexicalRulesHandler::export_automata(std::vector<std::shared_ptr<Automaton>> &automata,
                                                                 const std::string &output_file_path) {
-    std::shared_ptr<Automaton> nfa = Utilities::unionAutomataSet(automata);
+    for (const auto &pair: this->token_actions) {
+        if (std::find(this->modes.begin(), this->modes.end(), pair.second) == this->modes.end()) {
+            throw std::runtime_error("Token " + pair.first + " enters an unknown lexer mode: " + pair.second);
+        }
+    }
+    bool has_modes = this->modes.size() > 1;
+    std::shared_ptr<Automaton> nfa = has_modes ? union_modes(automata) : Utilities::unionAutomataSet(automata);
     std::shared_ptr<Automaton> dfa = conversions.convertToDFA(nfa, true);
+    resolve_tokens(dfa);
+    if (has_modes) {
+        add_mode_actions(dfa);
+    }
     dfa->export_to_file(output_file_path);
     /*TODO: i don't know why yet, but you shouldn't minimize the dfa as it will lose details about the
      * tokens identification */
@@ -57,16 +70,185 @@ std::shared_ptr<Automaton> LexicalRulesHandler::export_automata(std::vector<std:
     return dfa;
 }
 
+void LexicalRulesHandler::layout_hot_states(std::shared_ptr<Automaton> &dfa, std::string_view training_program) {
+    Lexer lexer(dfa);
+    const CompiledDFA &compiled = lexer.get_dfa();
+    std::vector<uint64_t> visits = lexer.count_state_visits(training_program);
+
+    // the entry states go first whatever their visits are, in the order of the modes
+    std::vector<int32_t> rows(compiled.get_states_count());
+    for (int32_t row = 0; row < compiled.get_states_count(); row++) {
+        rows[row] = row;
+    }
+    for (int32_t mode = compiled.get_modes_count() - 1; mode >= 0; mode--) {
+        visits[compiled.get_entry(mode)] = std::numeric_limits<uint64_t>::max() - mode;
+    }
+    std::stable_sort(rows.begin(), rows.end(), [&visits](int32_t a, int32_t b) {
+        return visits[a] > visits[b];
+    });
+
+    // the start state, then the states with a row from the hottest one, then the states without a row
+    auto ids_count = (int32_t) dfa->get_states().size();
+    std::vector<std::shared_ptr<State>> states(ids_count);
+    for (const std::shared_ptr<State> &state_ptr: dfa->get_states()) {
+        states[state_ptr->getId()] = state_ptr;
+    }
+    std::vector<std::shared_ptr<State>> order{dfa->get_start()};
+    std::vector<bool> placed(ids_count, false);
+    placed[dfa->get_start()->getId()] = true;
+    for (int32_t row: rows) {
+        int32_t id = compiled.get_state_id(row);
+        if (!placed[id]) {
+            placed[id] = true;
+            order.push_back(states[id]);
+        }
+    }
+    for (int32_t id = 0; id < ids_count; id++) {
+        if (!placed[id]) {
+            order.push_back(states[id]);
+        }
+    }
+    // like give_new_ids_all, the states change in place, so the hashes of the sets keys are stale from here on
+    for (int32_t id = 0; id < ids_count; id++) {
+        order[id]->setId(id);
+    }
+}
+
+std::shared_ptr<Automaton> LexicalRulesHandler::union_modes(std::vector<std::shared_ptr<Automaton>> &automata) {
+    std::shared_ptr<Automaton> nfa = std::make_shared<Automaton>();
+    nfa->set_epsilon_symbol(this->epsilonSymbol);
+    auto start = std::make_shared<State>(-1, false, "");
+    nfa->set_start(start);
+    nfa->add_state(start);
+    std::string regex{};
+    for (const std::string &mode: this->modes) {
+        std::vector<std::shared_ptr<Automaton>> mode_automata{};
+        for (const std::shared_ptr<Automaton> &a: automata) {
+            const std::vector<std::string> &a_modes = this->token_modes[a->get_token()];
+            if (std::find(a_modes.begin(), a_modes.end(), mode) != a_modes.end()) {
+                mode_automata.push_back(a);
+            }
+        }
+        if (mode_automata.empty()) {
+            throw std::runtime_error("Lexer mode has no tokens: " + mode);
+        }
+        std::shared_ptr<Automaton> mode_nfa = Utilities::unionAutomataSet(mode_automata);
+        // the ids must differ from the ones of the modes before, states are compared by id
+        mode_nfa->give_new_ids_all(static_cast<int>(nfa->get_states().size()) + 1, true);
+        nfa->add_states(mode_nfa->get_states());
+        nfa->add_alphabets(mode_nfa->get_alphabets());
+        nfa->add_transitions(mode_nfa->get_transitions());
+        nfa->add_accepting_states(mode_nfa->get_accepting_states());
+
+        std::string symbol = Automaton::MODE_SYMBOL_PREFIX + mode;
+        nfa->add_alphabet(symbol);
+        nfa->add_transitions(start, symbol, {mode_nfa->get_start()});
+        if (!regex.empty()) {
+            regex += "|";
+        }
+        regex += symbol + mode_nfa->get_regex();
+    }
+    nfa->set_regex("(" + regex + ")");
+    nfa->give_new_ids_all();
+    return nfa;
+}
+
+void LexicalRulesHandler::add_mode_actions(std::shared_ptr<Automaton> &dfa) {
+    // the entry state of every mode: the start state goes there on the symbol of the mode
+    std::unordered_map<std::string, std::shared_ptr<State>> entries{};
+    for (const auto &pair: dfa->get_transitions()) {
+        if (pair.first.first == dfa->get_start() && pair.first.second.rfind(Automaton::MODE_SYMBOL_PREFIX, 0) == 0) {
+            entries[pair.first.second] = *pair.second.begin();
+        }
+    }
+    // the dfa is complete, every state already goes to the dead state on the symbols of the modes.
+    // Iterate over the transitions instead of looking states up in them, like resolve_tokens.
+    for (auto &pair: dfa->get_transitions()) {
+        auto action = this->token_actions.find(pair.first.first->getToken());
+        if (action != this->token_actions.end() && pair.first.first != dfa->get_start()
+            && pair.first.second == Automaton::MODE_SYMBOL_PREFIX + action->second) {
+            pair.second = {entries.at(pair.first.second)};
+        }
+    }
+}
+
+void LexicalRulesHandler::add_token(const std::string &token, const std::vector<std::string> &current_modes,
+                                    const std::string &action) {
+    std::vector<std::string> &modes_of_token = this->token_modes[token];
+    modes_of_token.insert(modes_of_token.end(), current_modes.begin(), current_modes.end());
+    if (!action.empty()) {
+        this->token_actions[token] = action;
+    }
+}
+
+std::string LexicalRulesHandler::take_action(std::string &line) {
+    std::size_t position = line.find("%enter");
+    if (position == std::string::npos) {
+        return "";
+    }
+    std::string action = line.substr(position + 6);
+    this->trim(action);
+    if (action.empty() || action.find_first_of(" \t") != std::string::npos) {
+        throw std::runtime_error("%enter needs one mode name: " + line);
+    }
+    line = line.substr(0, position);
+    this->trim(line);
+    return action;
+}
+
+void LexicalRulesHandler::resolve_tokens(std::shared_ptr<Automaton> &dfa) {
+    std::map<std::string, int> priorities_map = this->get_priorities();
+    // iterate over the tokens map instead of looking states up in it, the ids (hence the hashes) of its keys
+    // were changed by give_new_ids_all after they were inserted
+    for (const auto &pair: dfa->get_tokens()) {
+        // the token with the highest priority wins the state
+        std::string chosen_token{};
+        int max_priority = std::numeric_limits<int>::min();
+        for (const std::string &token: pair.second) {
+            auto it = priorities_map.find(token);
+            if (it != priorities_map.end() && max_priority < it->second) {
+                max_priority = it->second;
+                chosen_token = token;
+            }
+        }
+        pair.first->setToken(chosen_token);
+    }
+}
+
 [[maybe_unused]] std::unordered_map<std::string, std::shared_ptr<Automaton>>
 LexicalRulesHandler::handleFile(const std::string &filename) {
     this->priorities = {};
+    this->modes = {Automaton::INITIAL_MODE};
+    this->token_modes = {};
+    this->token_actions = {};
+    std::vector<std::string> current_modes{Automaton::INITIAL_MODE};
     std::unordered_map<std::string, std::shared_ptr<Automaton>> automata{};
     std::vector<std::string> regex_tokens{};
     std::queue<std::pair<std::string, std::string>> backlog;
     std::ifstream file(filename);
     std::string line{};
     while (std::getline(file, line)) {
+        if (line.find_first_not_of(" \n\r\t") == std::string::npos) {
+            continue;
+        }
         line = line.substr(line.find_first_not_of(" \n\r\t"), std::string::npos);
+        if (line.rfind("%mode", 0) == 0) {
+            // the tokens of the lines after this one are in the modes it names
+            std::istringstream ss(line.substr(5));
+            current_modes.clear();
+            std::string mode;
+            while (ss >> mode) {
+                current_modes.push_back(mode);
+                if (std::find(this->modes.begin(), this->modes.end(), mode) == this->modes.end()) {
+                    this->modes.push_back(mode);
+                }
+            }
+            if (current_modes.empty()) {
+                throw std::runtime_error("%mode needs at least one mode name: " + line);
+            }
+            continue;
+        }
+        std::string action = this->take_action(line);
         std::string non_terminal = line.substr(0, line.find_first_of(" \n\r\t"));
         bool is_regular_definition = non_terminal.back() == ':';
 
@@ -80,6 +262,7 @@ LexicalRulesHandler::handleFile(const std::string &filename) {
                 a->set_token(keyword);
                 automata[keyword] = a;
                 this->priorities.push_back(keyword);
+                this->add_token(keyword, current_modes, action);
             }
         } else if (line.front() == '[') {
             // These are punctuation
@@ -97,6 +280,7 @@ LexicalRulesHandler::handleFile(const std::string &filename) {
                 // TODO: see if you want to replace the next line with {automata["punctuation"].append(a);}
                 automata[punctuation] = a;
                 this->priorities.push_back(punctuation);
+                this->add_token(punctuation, current_modes, action);
             }
         } else if (is_regular_definition) {
             // This is a regular definition
@@ -112,8 +296,12 @@ LexicalRulesHandler::handleFile(const std::string &filename) {
                 automata[name] = a;
             }
             this->priorities.push_back(name);
+            this->add_token(name, current_modes, action);
         } else if (line.find('=') != std::string::npos) {
             // This is a regular definition
+            if (!action.empty()) {
+                throw std::runtime_error("Only tokens can enter a lexer mode: " + line);
+            }
             std::string name = line.substr(0, line.find('='));
             this->trim(name);
             std::string regex = line.substr(line.find('=') + 1);
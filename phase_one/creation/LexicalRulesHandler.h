@@ -7,6 +7,7 @@
 #include <string>
 #include <queue>
 #include <map>
+#include <string_view>
 #include "../automaton/Automaton.h"
 #include "ToAutomaton.h"
 
@@ -21,10 +22,27 @@ public:
     // call this method only after you have called handleFile
     std::map<std::string, int> get_priorities();
 
-    // will make a union on the automata and then output them to the output file path
+    // will make a union on the automata and then output them to the output file path,
+    // the token of every accepting state of the result is resolved to the one with the highest priority.
+    // If the rules have lexer modes, the result has one entry state for every mode (see union_modes).
     std::shared_ptr<Automaton>
     export_automata(std::vector<std::shared_ptr<Automaton>> &automata, const std::string &output_file_path);
 
+    /**
+     * Renumbers the states of the final dfa (as exported by export_automata) by how often the scanner visits them
+     * on a training program: the start state first, then the entry states of the modes, then the hottest states.
+     * The compiled table keeps the order of the ids, so the rows the scanner reads the most sit together in a few
+     * cache lines. Export the dfa again to keep the layout.
+     */
+    static void layout_hot_states(std::shared_ptr<Automaton> &dfa, std::string_view training_program);
+
+    /**
+     * Reads a rules file, returns the automaton of every token.
+     *
+     * A line "%mode name..." starts a section, the tokens of the lines after it are in the named lexer modes
+     * (the tokens before the first section are in the INITIAL mode). A token line can end with "%enter name",
+     * after the token the scanner goes on in that mode.
+     */
     [[maybe_unused]] std::unordered_map<std::string, std::shared_ptr<Automaton>>
     handleFile(const std::string &filename);
 
@@ -37,6 +55,31 @@ private:
     std::unordered_map<std::string, int> attempts{};
     const int MAX_ATTEMPTS = 100;
 
+    // the lexer modes in the order of the rules file, the initial mode first
+    std::vector<std::string> modes{};
+    // the modes every token is in
+    std::unordered_map<std::string, std::vector<std::string>> token_modes{};
+    // the mode a token enters, if it changes the mode
+    std::unordered_map<std::string, std::string> token_actions{};
+
+    // records the modes of a token and the mode it enters (if action isn't empty)
+    void add_token(const std::string &token, const std::vector<std::string> &current_modes,
+                   const std::string &action);
+
+    // removes the "%enter name" at the end of a rule line, returns the name (empty if there is none)
+    std::string take_action(std::string &line);
+
+    // unions the automata of every mode on its own, then joins the modes under a new start state that goes to the
+    // start of every mode on the symbol of the mode (Automaton::MODE_SYMBOL_PREFIX + mode).
+    std::shared_ptr<Automaton> union_modes(std::vector<std::shared_ptr<Automaton>> &automata);
+
+    // adds a transition from every accepting state of the final dfa whose token enters a mode to the entry state
+    // of that mode, on the symbol of the mode.
+    void add_mode_actions(std::shared_ptr<Automaton> &dfa);
+
+
+    // sets the token of every accepting state of the final dfa to its candidate token with the highest priority
+    void resolve_tokens(std::shared_ptr<Automaton> &dfa);
 
     void handle_backlog(std::unordered_map<std::string, std::shared_ptr<Automaton>> &automata,
                         std::queue<std::pair<std::string, std::string>> &backlog,
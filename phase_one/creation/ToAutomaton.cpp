@@ -6,6 +6,8 @@
 #include "../automaton/Utilities.h"
 
 std::shared_ptr<Automaton> ToAutomaton::regex_to_minimized_dfa(std::string regex, const std::string &epsilon_symbol) {
+    // the Unicode characters and ranges become placeholder bytes, the parser only knows single bytes
+    this->fragments = Utf8Ranges::extract(regex, epsilon_symbol);
     // Parse the regex and construct the corresponding postfix
     std::string postfix = infixToPostfix.regex_infix_to_postfix(std::move(regex));
     // parse the postfix regex (easier) to an Automaton
@@ -18,7 +20,7 @@ std::shared_ptr<Automaton> ToAutomaton::regex_to_minimized_dfa(std::string regex
      *TODO: see which type of regex do you want the automaton to have
      * this:
      */
-    minDFa->set_regex(infixToPostfix.regex_evaluate_postfix(postfix));
+    minDFa->set_regex(Utf8Ranges::restore(infixToPostfix.regex_evaluate_postfix(postfix), this->fragments));
     /*TODO:
      * or this:
      */
@@ -29,8 +31,11 @@ std::shared_ptr<Automaton> ToAutomaton::regex_to_minimized_dfa(std::string regex
 std::shared_ptr<Automaton> ToAutomaton::regular_definition_to_minimized_dfa(const std::string &regular_definition,
                                                                             const std::unordered_map<std::string, std::shared_ptr<Automaton>> &automata,
                                                                             const std::string &epsilon_symbol) {
+    // the Unicode characters and ranges become placeholder bytes, every placeholder is a token of its own
+    std::string definition = regular_definition;
+    this->fragments = Utf8Ranges::extract(definition, epsilon_symbol);
     // transform the regular definition to tokens to make it easy to handle
-    std::vector<std::string> tokens = infixToPostfix.tokenize(regular_definition);
+    std::vector<std::string> tokens = infixToPostfix.tokenize(definition);
     // Parse the regular definition and construct the corresponding postfix
     std::vector<std::string> rd_postfix = infixToPostfix.regular_definition_infix_to_postfix(tokens);
 
@@ -56,7 +61,10 @@ ToAutomaton::get_automaton_from_regex_postfix(const std::string &postfix, const
     std::stack<std::shared_ptr<Automaton>> stack;
     for (int i = 0; i < postfix.length(); i++) {
         char c = postfix[i];
-        if (!constants.is_operator(c)) {
+        auto fragment = this->fragments.find(c);
+        if (fragment != this->fragments.end()) {
+            stack.push(fragment->second.automaton);
+        } else if (!constants.is_operator(c)) {
             stack.push(std::make_shared<Automaton>(std::string(1, c), "", epsilonSymbol));
         } else {
             if ((i < postfix.length() - 1) && (constants.ESCAPE == postfix[i + 1]) && (constants.is_operator(c))) {
@@ -191,6 +199,9 @@ std::shared_ptr<Automaton> ToAutomaton::get_automaton_from_regular_definition(st
 std::shared_ptr<Automaton> ToAutomaton::get_automaton_from_map(const std::string &token,
                                                                const std::unordered_map<std::string, std::shared_ptr<Automaton>> &map,
                                                                const std::string &epsilonSymbol) {
+    if (token.size() == 1 && this->fragments.find(token[0]) != this->fragments.end()) {
+        return this->fragments.at(token[0]).automaton;
+    }
     auto it = map.find(token);
     if (it != map.end()) {
         // If the token exists in the map, return the corresponding Automaton
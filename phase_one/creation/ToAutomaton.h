@@ -1,5 +1,6 @@
 #include "Constants.h"
 #include "InfixToPostfix.h"
+#include "Utf8Ranges.h"
 #include "../automaton/Conversions.h"
 
 #ifndef COMPILER_PROJECT_PARSING_H
@@ -36,6 +37,9 @@ private:
 
     Conversions conversions;
 
+    // the automata of the placeholder bytes of the rule being parsed (see Utf8Ranges::extract)
+    std::unordered_map<char, Utf8Ranges::Fragment> fragments;
+
     /**
      * Converts a regular expression into a minimized DFA.
      *
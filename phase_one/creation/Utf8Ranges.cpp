@@ -0,0 +1,291 @@
+#include <iomanip>
+#include <sstream>
+#include <stdexcept>
+#include "Utf8Ranges.h"
+
+namespace {
+    // the largest code point of every length of encoding
+    constexpr uint32_t MAX_ONE_BYTE = 0x7F;
+    constexpr uint32_t MAX_TWO_BYTES = 0x7FF;
+    constexpr uint32_t MAX_THREE_BYTES = 0xFFFF;
+
+    constexpr uint32_t FIRST_SURROGATE = 0xD800;
+    constexpr uint32_t LAST_SURROGATE = 0xDFFF;
+
+    int encoded_length(uint32_t code_point) {
+        if (code_point <= MAX_ONE_BYTE) {
+            return 1;
+        }
+        if (code_point <= MAX_TWO_BYTES) {
+            return 2;
+        }
+        if (code_point <= MAX_THREE_BYTES) {
+            return 3;
+        }
+        return 4;
+    }
+
+    // "\u{c0}-\u{24f}", the text of a range in the regex of its automaton
+    std::string range_text(uint32_t low, uint32_t high) {
+        std::ostringstream text{};
+        text << std::hex << "\\u{" << low << "}";
+        if (high != low) {
+            text << "-\\u{" << high << "}";
+        }
+        return text.str();
+    }
+
+    // a character that can end a range (a-\u{ff}) without being Unicode itself
+    bool is_ascii_atom(char c) {
+        static const std::string OPERATORS = "\\*+-.|()";
+        return c > ' ' && c < '\x7f' && OPERATORS.find(c) == std::string::npos;
+    }
+}
+
+std::vector<Utf8Ranges::ByteSequence> Utf8Ranges::split(uint32_t low, uint32_t high) {
+    std::vector<ByteSequence> sequences{};
+    // the ranges left to split, the lowest one on top
+    std::vector<std::pair<uint32_t, uint32_t>> pending{{low, high}};
+    while (!pending.empty()) {
+        auto [from, to] = pending.back();
+        pending.pop_back();
+
+        if (from <= LAST_SURROGATE && to >= FIRST_SURROGATE) {
+            // surrogates have no encoding
+            if (to > LAST_SURROGATE) {
+                pending.emplace_back(LAST_SURROGATE + 1, to);
+            }
+            if (from < FIRST_SURROGATE) {
+                pending.emplace_back(from, FIRST_SURROGATE - 1);
+            }
+            continue;
+        }
+
+        // every code point of a sequence has the same length of encoding
+        int length = encoded_length(from);
+        if (length != encoded_length(to)) {
+            uint32_t max = length == 1 ? MAX_ONE_BYTE : length == 2 ? MAX_TWO_BYTES : MAX_THREE_BYTES;
+            pending.emplace_back(max + 1, to);
+            pending.emplace_back(from, max);
+            continue;
+        }
+
+        // a byte may take all its values only if the bytes after it take all theirs too,
+        // so the range is split where its trailing 6-bit groups aren't full
+        bool was_split = false;
+        for (int i = 1; i < length && !was_split; i++) {
+            uint32_t mask = (1u << (6 * i)) - 1;
+            if ((from & ~mask) == (to & ~mask)) {
+                continue;
+            }
+            if ((from & mask) != 0) {
+                pending.emplace_back((from | mask) + 1, to);
+                pending.emplace_back(from, from | mask);
+                was_split = true;
+            } else if ((to & mask) != mask) {
+                pending.emplace_back(to & ~mask, to);
+                pending.emplace_back(from, (to & ~mask) - 1);
+                was_split = true;
+            }
+        }
+        if (was_split) {
+            continue;
+        }
+
+        std::string first{};
+        std::string last{};
+        encode(from, first);
+        encode(to, last);
+        ByteSequence sequence{};
+        for (std::size_t i = 0; i < first.size(); i++) {
+            sequence.emplace_back(static_cast<unsigned char>(first[i]), static_cast<unsigned char>(last[i]));
+        }
+        sequences.push_back(sequence);
+    }
+    return sequences;
+}
+
+std::shared_ptr<Automaton> Utf8Ranges::to_automaton(uint32_t low, uint32_t high, const std::string &epsilon_symbol) {
+    if (low > high || high > MAX_CODE_POINT) {
+        throw std::runtime_error("Invalid code point range: " + range_text(low, high));
+    }
+    std::vector<ByteSequence> sequences = split(low, high);
+    if (sequences.empty()) {
+        throw std::runtime_error("Code point range has no UTF-8 encoding: " + range_text(low, high));
+    }
+
+    // one chain of states for every sequence, from the same start state to the same accepting state
+    std::string text = range_text(low, high);
+    std::shared_ptr<Automaton> nfa = std::make_shared<Automaton>();
+    nfa->set_epsilon_symbol(epsilon_symbol);
+    int id = 0;
+    std::shared_ptr<State> start = std::make_shared<State>(id++, false, "");
+    std::shared_ptr<State> accepting = std::make_shared<State>(id++, true, text);
+    nfa->add_state(start);
+    nfa->add_state(accepting);
+    nfa->set_start(start);
+    nfa->add_accepting_state(accepting);
+    for (const ByteSequence &sequence: sequences) {
+        std::shared_ptr<State> from = start;
+        for (std::size_t i = 0; i < sequence.size(); i++) {
+            std::shared_ptr<State> to = accepting;
+            if (i + 1 < sequence.size()) {
+                to = std::make_shared<State>(id++, false, "");
+                nfa->add_state(to);
+            }
+            for (unsigned int byte = sequence[i].first; byte <= sequence[i].second; byte++) {
+                std::string symbol(1, static_cast<char>(byte));
+                nfa->add_alphabet(symbol);
+                nfa->add_transitions(from, symbol, {to});
+            }
+            from = to;
+        }
+    }
+
+    Conversions conversions{};
+    std::shared_ptr<Automaton> dfa = conversions.convertToDFA(nfa, false);
+    std::shared_ptr<Automaton> minimized_dfa = conversions.minimizeDFA(dfa);
+    minimized_dfa->set_regex("(" + text + ")");
+    return minimized_dfa;
+}
+
+std::unordered_map<char, Utf8Ranges::Fragment> Utf8Ranges::extract(std::string &rule,
+                                                                   const std::string &epsilon_symbol) {
+    std::unordered_map<char, Fragment> fragments{};
+    // the same atom written twice in a rule shares its placeholder
+    std::unordered_map<std::string, char> placeholders{};
+    std::string result{};
+    std::size_t i = 0;
+    while (i < rule.size()) {
+        if (is_placeholder(rule[i])) {
+            throw std::runtime_error("Rules can't contain control characters: " + rule);
+        }
+        std::size_t begin = i;
+        uint32_t low = 0;
+        bool unicode = read_code_point(rule, i, low);
+        if (!unicode) {
+            if (rule[i] == '\\' && i + 1 < rule.size()) {
+                // an escaped operator is never part of a range
+                result.append(rule, i, 2);
+                i += 2;
+                continue;
+            }
+            if (!is_ascii_atom(rule[i])) {
+                result += rule[i++];
+                continue;
+            }
+            low = static_cast<unsigned char>(rule[i++]);
+        }
+
+        uint32_t high = low;
+        std::size_t end = i;
+        if (i + 1 < rule.size() && rule[i] == '-') {
+            std::size_t j = i + 1;
+            uint32_t code_point = 0;
+            if (read_code_point(rule, j, code_point)) {
+                high = code_point;
+                end = j;
+                unicode = true;
+            } else if (unicode && is_ascii_atom(rule[j])) {
+                high = static_cast<unsigned char>(rule[j]);
+                end = j + 1;
+            }
+        }
+        if (!unicode) {
+            // an ASCII character or range, the parser handles it
+            result += rule[begin];
+            i = begin + 1;
+            continue;
+        }
+
+        std::string text = rule.substr(begin, end - begin);
+        auto it = placeholders.find(text);
+        if (it == placeholders.end()) {
+            auto placeholder = static_cast<char>(FIRST_PLACEHOLDER + fragments.size());
+            if (placeholder > LAST_PLACEHOLDER) {
+                throw std::runtime_error("Too many Unicode characters and ranges in one rule: " + rule);
+            }
+            fragments[placeholder] = Fragment{text, to_automaton(low, high, epsilon_symbol)};
+            it = placeholders.emplace(text, placeholder).first;
+        }
+        result += it->second;
+        i = end;
+    }
+    rule = result;
+    return fragments;
+}
+
+std::string Utf8Ranges::restore(std::string rule, const std::unordered_map<char, Fragment> &fragments) {
+    std::string result{};
+    for (char c: rule) {
+        auto it = fragments.find(c);
+        if (it != fragments.end()) {
+            result += it->second.text;
+        } else {
+            result += c;
+        }
+    }
+    return result;
+}
+
+bool Utf8Ranges::is_placeholder(char c) {
+    return c >= FIRST_PLACEHOLDER && c <= LAST_PLACEHOLDER;
+}
+
+void Utf8Ranges::encode(uint32_t code_point, std::string &out) {
+    if (code_point <= MAX_ONE_BYTE) {
+        out += static_cast<char>(code_point);
+    } else if (code_point <= MAX_TWO_BYTES) {
+        out += static_cast<char>(0xC0 | (code_point >> 6));
+        out += static_cast<char>(0x80 | (code_point & 0x3F));
+    } else if (code_point <= MAX_THREE_BYTES) {
+        out += static_cast<char>(0xE0 | (code_point >> 12));
+        out += static_cast<char>(0x80 | ((code_point >> 6) & 0x3F));
+        out += static_cast<char>(0x80 | (code_point & 0x3F));
+    } else {
+        out += static_cast<char>(0xF0 | (code_point >> 18));
+        out += static_cast<char>(0x80 | ((code_point >> 12) & 0x3F));
+        out += static_cast<char>(0x80 | ((code_point >> 6) & 0x3F));
+        out += static_cast<char>(0x80 | (code_point & 0x3F));
+    }
+}
+
+bool Utf8Ranges::read_code_point(const std::string &rule, std::size_t &i, uint32_t &code_point) {
+    if (rule.compare(i, 3, "\\u{") == 0) {
+        std::size_t close = rule.find('}', i + 3);
+        std::string hex = close == std::string::npos ? "" : rule.substr(i + 3, close - i - 3);
+        if (hex.empty() || hex.size() > 6 || hex.find_first_not_of("0123456789abcdefABCDEF") != std::string::npos) {
+            throw std::runtime_error("Invalid code point escape in rule: " + rule);
+        }
+        code_point = (uint32_t) std::stoul(hex, nullptr, 16);
+        if (code_point > MAX_CODE_POINT) {
+            throw std::runtime_error("Code point is out of range in rule: " + rule);
+        }
+        i = close + 1;
+        return true;
+    }
+
+    auto lead = static_cast<unsigned char>(rule[i]);
+    if (lead < 0x80) {
+        return false;
+    }
+    // a UTF-8 character written as it is
+    int length = lead >= 0xF0 && lead <= 0xF4 ? 4 : lead >= 0xE0 ? 3 : lead >= 0xC2 && lead <= 0xDF ? 2 : 0;
+    if (length == 0 || lead > 0xF4 || i + length > rule.size()) {
+        throw std::runtime_error("Invalid UTF-8 in rule: " + rule);
+    }
+    code_point = lead & (0x7F >> length);
+    for (int k = 1; k < length; k++) {
+        auto c = static_cast<unsigned char>(rule[i + k]);
+        if ((c & 0xC0) != 0x80) {
+            throw std::runtime_error("Invalid UTF-8 in rule: " + rule);
+        }
+        code_point = (code_point << 6) | (c & 0x3F);
+    }
+    if (encoded_length(code_point) != length || (code_point >= FIRST_SURROGATE && code_point <= LAST_SURROGATE)
+        || code_point > MAX_CODE_POINT) {
+        throw std::runtime_error("Invalid UTF-8 in rule: " + rule);
+    }
+    i += length;
+    return true;
+}
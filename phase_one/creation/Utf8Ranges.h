@@ -0,0 +1,83 @@
+#ifndef COMPILER_PROJECT_UTF8RANGES_H
+#define COMPILER_PROJECT_UTF8RANGES_H
+
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "../automaton/Automaton.h"
+#include "../automaton/Conversions.h"
+
+/**
+ * This class compiles the Unicode characters of the rules into automata over bytes, so the scanner stays a byte
+ * table and never decodes the input.
+ *
+ * A rule can contain code points, written \u{hex} or as the UTF-8 character itself, and ranges of code points
+ * (\u{c0}-\u{24f}, à-ÿ or a-\u{ff}). A range is split into sequences of byte ranges that cover the UTF-8
+ * encodings of its code points exactly (e.g. \u{80}-\u{7ff} is [c2-df][80-bf]), and the sequences become a small
+ * DFA over the bytes. Surrogates (\u{d800}-\u{dfff}) have no UTF-8 encoding, ranges skip them.
+ *
+ * The rules are parsed a byte at a time, so every Unicode atom of a rule is replaced by a placeholder control byte
+ * before parsing, and the parser uses the automaton of the placeholder wherever it finds one.
+ */
+class Utf8Ranges {
+public:
+    static constexpr uint32_t MAX_CODE_POINT = 0x10FFFF;
+
+    // byte_ranges[i] is the range of the i-th byte of the encodings, every byte of it is allowed
+    using ByteSequence = std::vector<std::pair<unsigned char, unsigned char>>;
+
+    // a Unicode atom of a rule: its text in the rule and its automaton
+    struct Fragment {
+        std::string text{};
+        std::shared_ptr<Automaton> automaton{};
+    };
+
+    /**
+     * Splits the code points [low, high] into sequences of byte ranges, the encodings of the code points are exactly
+     * the byte strings the sequences match.
+     */
+    static std::vector<ByteSequence> split(uint32_t low, uint32_t high);
+
+    /**
+     * Returns the minimized DFA of the UTF-8 encodings of the code points [low, high].
+     */
+    static std::shared_ptr<Automaton> to_automaton(uint32_t low, uint32_t high, const std::string &epsilon_symbol);
+
+    /**
+     * Replaces every Unicode atom of a rule (a code point or a range of code points) by a placeholder byte.
+     * ASCII characters and ranges are left as they are.
+     *
+     * @return the fragments of the placeholders, empty if the rule has no Unicode atom
+     */
+    static std::unordered_map<char, Fragment> extract(std::string &rule, const std::string &epsilon_symbol);
+
+    /**
+     * Puts the text of the fragments back in place of their placeholders.
+     */
+    static std::string restore(std::string rule, const std::unordered_map<char, Fragment> &fragments);
+
+    /**
+     * Checks if a byte is one of the placeholders extract uses.
+     */
+    static bool is_placeholder(char c);
+
+    /**
+     * Appends the UTF-8 encoding of a code point.
+     */
+    static void encode(uint32_t code_point, std::string &out);
+
+private:
+    // placeholders are control bytes that aren't white spaces, the rules don't use them
+    static constexpr char FIRST_PLACEHOLDER = '\x0e';
+    static constexpr char LAST_PLACEHOLDER = '\x1f';
+
+    // reads a code point at position i (\u{hex} or a UTF-8 character), returns false if there is none
+    static bool read_code_point(const std::string &rule, std::size_t &i, uint32_t &code_point);
+};
+
+
+#endif
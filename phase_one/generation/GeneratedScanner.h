@@ -0,0 +1,53 @@
+#ifndef COMPILER_PROJECT_GENERATEDSCANNER_H
+#define COMPILER_PROJECT_GENERATEDSCANNER_H
+
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include "../prediction/Diagnostics.h"
+#include "../prediction/Token.h"
+#include "../prediction/TokenBuffer.h"
+
+/**
+ * The scanner generated by ScannerGenerator from the lexical rules at build time (see the Generated_Scanner target).
+ * It scans the same tokens as Predictor, but the DFA is compiled into the code so it needs no data files.
+ */
+class GeneratedScanner {
+public:
+    /**
+     * Scans from position to the end of one token, returns false if no token was accepted on the way.
+     * The invalid characters skipped on the way are added to diagnostics.
+     */
+    static bool scan_token(std::string_view text, std::size_t &position, Token &token, Diagnostics &diagnostics);
+
+    /**
+     * Returns the name of a token kind, kinds are numbered like in CompiledDFA.
+     */
+    static const std::string &get_kind_name(int32_t kind);
+
+    /**
+     * Returns the number of token kinds.
+     */
+    static int32_t get_kinds_count();
+
+    /**
+     * Scans a whole program into a struct of arrays.
+     */
+    static TokenBuffer tokenize_all(std::string_view text) {
+        TokenBuffer buffer{};
+        buffer.reserve(text.size() / 8);
+        std::size_t position = 0;
+        Token token{};
+        while (position < text.size()) {
+            if (scan_token(text, position, token, buffer.diagnostics)) {
+                buffer.push_back(token);
+            }
+        }
+        return buffer;
+    }
+};
+
+
+#endif
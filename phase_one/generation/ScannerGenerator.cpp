@@ -0,0 +1,236 @@
+#include <fstream>
+#include <map>
+#include <queue>
+#include <sstream>
+#include <stdexcept>
+#include <utility>
+#include "ScannerGenerator.h"
+
+ScannerGenerator::ScannerGenerator(std::shared_ptr<CompiledDFA> dfa) {
+    this->dfa = std::move(dfa);
+}
+
+void ScannerGenerator::export_to_file(const std::string &output_file_path, const std::string &rules_file_path) const {
+    // write to memory first, so a failed generation doesn't leave half a file behind
+    std::ostringstream source{};
+    this->write(source, rules_file_path);
+
+    std::ofstream outfile(output_file_path);
+    if (!outfile) {
+        throw std::runtime_error("Failed to open file: " + output_file_path);
+    }
+    outfile << source.str();
+    outfile.close();
+    if (!outfile) {
+        throw std::runtime_error("Failed to write file: " + output_file_path);
+    }
+}
+
+void ScannerGenerator::write(std::ostream &out, const std::string &rules_file_path) const {
+    if (this->dfa->get_modes_count() > 1) {
+        // the generated scan_token has no mode to start from
+        throw std::runtime_error("Lexer modes aren't supported by the generated scanner: " + rules_file_path);
+    }
+    int32_t start = this->dfa->get_start();
+    std::vector<bool> reachable = this->find_reachable_states();
+
+    // a state needs a label only if a transition goes to it
+    std::vector<bool> targeted(this->dfa->get_states_count(), false);
+    for (int32_t state = 0; state < this->dfa->get_states_count(); state++) {
+        if (reachable[state]) {
+            for (const auto &target: this->get_targets(state)) {
+                targeted[target.first] = true;
+            }
+        }
+    }
+
+    out << "// Generated by scanner_generator from " << rules_file_path << ", do not edit.\n";
+    out << "// Every state of the final DFA is a label, every transition a goto (see ScannerGenerator).\n\n";
+    out << "#include \"phase_one/generation/GeneratedScanner.h\"\n";
+    out << "#include \"phase_one/prediction/ByteRuns.h\"\n\n";
+
+    out << "namespace {\n";
+    out << "    const std::string KIND_NAMES[] = {\n";
+    for (int32_t kind = 0; kind < this->dfa->get_kinds_count(); kind++) {
+        out << "            " << string_literal(this->dfa->get_kind_name(kind)) << ",\n";
+    }
+    if (this->dfa->get_kinds_count() == 0) {
+        out << "            \"\",\n";
+    }
+    out << "    };\n";
+    out << "}\n\n";
+
+    out << "int32_t GeneratedScanner::get_kinds_count() {\n";
+    out << "    return " << this->dfa->get_kinds_count() << ";\n";
+    out << "}\n\n";
+
+    out << "const std::string &GeneratedScanner::get_kind_name(int32_t kind) {\n";
+    out << "    return KIND_NAMES[kind];\n";
+    out << "}\n\n";
+
+    out << "bool GeneratedScanner::scan_token(std::string_view text, std::size_t &position, Token &token,\n";
+    out << "                                  Diagnostics &diagnostics) {\n";
+    out << "    const char *const begin = text.data();\n";
+    out << "    const char *const end = begin + text.size();\n";
+    out << "    const char *p = begin + position;\n";
+    out << "    if (p < end && ByteRuns::is_white_space(*p)) {\n";
+    out << "        p = ByteRuns::skip(ByteRuns::WHITE_SPACE, p, end);\n";
+    out << "    }\n";
+    out << "    const char *const token_start = p;\n";
+    out << "    const char *token_end = p;\n";
+    out << "    int32_t token_kind = -1;\n\n";
+
+    // the first byte of a token is read from the start state, it is the only place an invalid byte is an error
+    std::vector<unsigned char> invalid_bytes{};
+    for (int c = 0; c < 256; c++) {
+        if (this->dfa->next(start, (unsigned char) c) == CompiledDFA::INVALID) {
+            invalid_bytes.push_back((unsigned char) c);
+        }
+    }
+    out << "    if (p == end) {\n";
+    out << "        goto done;\n";
+    out << "    }\n";
+    out << "    switch (static_cast<unsigned char>(*p)) {\n";
+    for (const auto &target: this->get_targets(start)) {
+        write_cases(out, target.second, "        ");
+        out << "            p++;\n";
+        out << "            goto state_" << target.first << ";\n";
+    }
+    if (!invalid_bytes.empty()) {
+        write_cases(out, invalid_bytes, "        ");
+        out << "            diagnostics.add(p - begin, 1);\n";
+        out << "            position = p - begin + 1;\n";
+        out << "            return false;\n";
+    }
+    out << "        default:\n";
+    out << "            goto done;\n";
+    out << "    }\n\n";
+
+    for (int32_t state = 0; state < this->dfa->get_states_count(); state++) {
+        if (!targeted[state]) {
+            continue;
+        }
+        out << "    state_" << state << ":\n";
+        int32_t accept_kind = this->dfa->get_accept_kind(state);
+        if (accept_kind != CompiledDFA::NO_TOKEN) {
+            out << "    token_kind = " << accept_kind << "; // " << this->dfa->get_kind_name(accept_kind) << "\n";
+            out << "    token_end = p;\n";
+        }
+        ByteRuns::RunKind run = this->dfa->get_run_kind(state);
+        if (run == ByteRuns::RANGES) {
+            // the accelerator of the state, as a constant the compiler can fold into the kernel
+            const ByteRuns::ByteRanges &ranges = this->dfa->get_accelerator(state);
+            std::string lows{};
+            std::string highs{};
+            for (int i = 0; i < ranges.count; i++) {
+                lows += (i == 0 ? "" : ", ") + std::to_string(ranges.low[i]);
+                highs += (i == 0 ? "" : ", ") + std::to_string(ranges.high[i]);
+            }
+            out << "    p = ByteRuns::skip(ByteRuns::ByteRanges{" << (int) ranges.count << ", {" << lows << "}, {" << highs
+                << "}}, p, end);\n";
+        } else if (run != ByteRuns::NONE) {
+            out << "    p = ByteRuns::skip(" << (run == ByteRuns::DIGITS ? "ByteRuns::DIGITS" : "ByteRuns::ALPHANUMERIC")
+                << ", p, end);\n";
+        }
+        if (run != ByteRuns::NONE && accept_kind != CompiledDFA::NO_TOKEN) {
+            out << "    token_end = p;\n";
+        }
+        std::vector<std::pair<int32_t, std::vector<unsigned char>>> targets = this->get_targets(state);
+        if (targets.empty()) {
+            out << "    goto done;\n\n";
+            continue;
+        }
+        out << "    if (p == end) {\n";
+        out << "        goto done;\n";
+        out << "    }\n";
+        out << "    switch (static_cast<unsigned char>(*p)) {\n";
+        for (const auto &target: targets) {
+            write_cases(out, target.second, "        ");
+            out << "            p++;\n";
+            out << "            goto state_" << target.first << ";\n";
+        }
+        out << "        default:\n";
+        out << "            goto done;\n";
+        out << "    }\n\n";
+    }
+
+    out << "    done:\n";
+    out << "    if (token_kind < 0) {\n";
+    out << "        if (token_start < end) {\n";
+    out << "            // no prefix was accepted, the first character can't start any token\n";
+    out << "            diagnostics.add(token_start - begin, 1);\n";
+    out << "            p = token_start + 1;\n";
+    out << "        }\n";
+    out << "        position = p - begin;\n";
+    out << "        return false;\n";
+    out << "    }\n";
+    out << "    // rewind to the end of the last accepted prefix\n";
+    out << "    position = token_end - begin;\n";
+    out << "    token.kind = token_kind;\n";
+    out << "    token.offset = (uint32_t) (token_start - begin);\n";
+    out << "    token.length = (uint32_t) (token_end - token_start);\n";
+    out << "    return true;\n";
+    out << "}\n";
+}
+
+std::vector<std::pair<int32_t, std::vector<unsigned char>>> ScannerGenerator::get_targets(int32_t state) const {
+    // ordered by target, so the generated file is the same on every run
+    std::map<int32_t, std::vector<unsigned char>> bytes_of_target{};
+    for (int c = 0; c < 256; c++) {
+        int32_t next_state = this->dfa->next(state, (unsigned char) c);
+        if (next_state >= 0) {
+            bytes_of_target[next_state].push_back((unsigned char) c);
+        }
+    }
+    return {bytes_of_target.begin(), bytes_of_target.end()};
+}
+
+std::vector<bool> ScannerGenerator::find_reachable_states() const {
+    std::vector<bool> reachable(this->dfa->get_states_count(), false);
+    std::queue<int32_t> queue{};
+    reachable[this->dfa->get_start()] = true;
+    queue.push(this->dfa->get_start());
+    while (!queue.empty()) {
+        int32_t state = queue.front();
+        queue.pop();
+        for (const auto &target: this->get_targets(state)) {
+            if (!reachable[target.first]) {
+                reachable[target.first] = true;
+                queue.push(target.first);
+            }
+        }
+    }
+    return reachable;
+}
+
+void ScannerGenerator::write_cases(std::ostream &out, const std::vector<unsigned char> &bytes,
+                                   const std::string &indent) {
+    const std::size_t cases_per_line = 8;
+    for (std::size_t i = 0; i < bytes.size(); i++) {
+        out << (i % cases_per_line == 0 ? indent : " ") << "case " << byte_literal(bytes[i]) << ":";
+        if (i % cases_per_line == cases_per_line - 1 || i + 1 == bytes.size()) {
+            out << "\n";
+        }
+    }
+}
+
+std::string ScannerGenerator::byte_literal(unsigned char c) {
+    if (c == '\'' || c == '\\') {
+        return std::string("'\\") + (char) c + "'";
+    }
+    if (c >= 0x20 && c < 0x7F) {
+        return std::string("'") + (char) c + "'";
+    }
+    return std::to_string((int) c);
+}
+
+std::string ScannerGenerator::string_literal(const std::string &s) {
+    std::string literal = "\"";
+    for (char c: s) {
+        if (c == '"' || c == '\\') {
+            literal += '\\';
+        }
+        literal += c;
+    }
+    return literal + "\"";
+}
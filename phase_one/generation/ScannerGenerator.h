@@ -0,0 +1,56 @@
+#ifndef COMPILER_PROJECT_SCANNERGENERATOR_H
+#define COMPILER_PROJECT_SCANNERGENERATOR_H
+
+
+#include <memory>
+#include <ostream>
+#include <string>
+#include <vector>
+#include "../prediction/CompiledDFA.h"
+
+/**
+ * This class writes a compiled DFA as a direct coded scanner: a C++ source file that implements GeneratedScanner.h,
+ * where every state is a label followed by a switch on the next byte and every transition is a goto.
+ * The generated scanner doesn't load anything at runtime, and it doesn't pay the table loads of CompiledDFA.
+ *
+ * It behaves exactly like Lexer::scan_token (maximal munch, white spaces end tokens, runs skipped with ByteRuns,
+ * invalid characters added to the diagnostics).
+ */
+class ScannerGenerator {
+public:
+    explicit ScannerGenerator(std::shared_ptr<CompiledDFA> dfa);
+
+    /**
+     * Writes the scanner source to a file, throws std::runtime_error if the file can't be written.
+     *
+     * @param output_file_path the generated .cpp file
+     * @param rules_file_path  only written in the header comment of the generated file
+     */
+    void export_to_file(const std::string &output_file_path, const std::string &rules_file_path) const;
+
+    /**
+     * Writes the scanner source to a stream.
+     */
+    void write(std::ostream &out, const std::string &rules_file_path) const;
+
+private:
+    std::shared_ptr<CompiledDFA> dfa{};
+
+    // groups the bytes of a state by the state they lead to, only real transitions (no sentinels) are kept
+    [[nodiscard]] std::vector<std::pair<int32_t, std::vector<unsigned char>>> get_targets(int32_t state) const;
+
+    // finds the states a scan can reach from the start state
+    [[nodiscard]] std::vector<bool> find_reachable_states() const;
+
+    // writes "case ...:" labels for a list of bytes, several per line
+    static void write_cases(std::ostream &out, const std::vector<unsigned char> &bytes, const std::string &indent);
+
+    // writes a byte as a C++ character literal (or a number if it isn't printable)
+    static std::string byte_literal(unsigned char c);
+
+    // writes a string as a C++ string literal
+    static std::string string_literal(const std::string &s);
+};
+
+
+#endif
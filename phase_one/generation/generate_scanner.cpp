@@ -0,0 +1,37 @@
+#include <iostream>
+#include "../creation/LexicalRulesHandler.h"
+#include "../prediction/CompiledDFA.h"
+#include "ScannerGenerator.h"
+
+/**
+ * Build step that turns the lexical rules into a direct coded scanner (see ScannerGenerator).
+ * The final DFA is built and exported exactly like the compiler does it, then imported back and compiled.
+ */
+int main(int argc, char *argv[]) {
+    if (argc < 4) {
+        std::cerr << "Usage: " << argv[0] << " <input_rules_path> <final_dfa_path> <output_source_path>\n";
+        return 1;
+    }
+    std::string input_rules_path = argv[1];
+    std::string final_dfa_path = argv[2];
+    std::string output_source_path = argv[3];
+
+    try {
+        LexicalRulesHandler handler{};
+        std::unordered_map<std::string, std::shared_ptr<Automaton>> automata = handler.handleFile(input_rules_path);
+        std::vector<std::shared_ptr<Automaton>> vector_automata{};
+        for (const auto &pair: automata) {
+            vector_automata.push_back(pair.second);
+        }
+        handler.export_automata(vector_automata, final_dfa_path);
+
+        std::shared_ptr<Automaton> final_dfa = Automaton::import_from_file(final_dfa_path);
+        Types::state_set_t dead_states = CompiledDFA::find_dead_states(final_dfa);
+        std::shared_ptr<CompiledDFA> dfa = std::make_shared<CompiledDFA>(final_dfa, dead_states);
+        ScannerGenerator(dfa).export_to_file(output_source_path, input_rules_path);
+    } catch (const std::exception &e) {
+        std::cerr << "scanner_generator: " << e.what() << '\n';
+        return 1;
+    }
+    return 0;
+}
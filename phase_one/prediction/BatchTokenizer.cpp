@@ -0,0 +1,227 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+#include "BatchTokenizer.h"
+#include "InterleavedScanner.h"
+#include "Predictor.h"
+#include "SourceBuffer.h"
+
+namespace {
+    void write_file(const std::string &path, const std::string &contents) {
+        std::ofstream outfile(path, std::ios::binary);
+        if (!outfile || !outfile.write(contents.data(), (std::streamsize) contents.size())) {
+            throw std::runtime_error("Failed to write file: " + path);
+        }
+    }
+}
+
+BatchTokenizer::BatchTokenizer(std::shared_ptr<const Lexer> lexer, unsigned int threads, std::size_t lanes) {
+    this->lexer = std::move(lexer);
+    this->threads = threads != 0 ? threads : std::max(1u, std::thread::hardware_concurrency());
+    this->lanes = std::clamp<std::size_t>(lanes, 1, InterleavedScanner::MAX_LANES);
+}
+
+BatchStatistics BatchTokenizer::run(const std::vector<std::string> &input_paths,
+                                    const std::string &output_directory) const {
+    std::error_code error{};
+    std::filesystem::create_directories(output_directory, error);
+    if (error) {
+        throw std::runtime_error("Failed to create directory: " + output_directory + " (" + error.message() + ")");
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    BatchStatistics batch{};
+    batch.files.resize(input_paths.size());
+    for (std::size_t i = 0; i < input_paths.size(); i++) {
+        batch.files[i].input_path = input_paths[i];
+        batch.files[i].output_path = get_output_path(input_paths[i], output_directory);
+    }
+
+    // every worker takes the next files until there are none left, so a few big files don't leave threads idle
+    std::atomic<std::size_t> next_file{0};
+    std::vector<std::thread> workers{};
+    unsigned int workers_count = std::min<std::size_t>(this->threads, input_paths.size());
+    for (unsigned int k = 0; k < workers_count; k++) {
+        workers.emplace_back([this, &batch, &next_file]() {
+            if (this->lanes > 1) {
+                this->tokenize_files(batch.files, next_file);
+                return;
+            }
+            for (std::size_t i = next_file++; i < batch.files.size(); i = next_file++) {
+                this->tokenize_file(batch.files[i]);
+            }
+        });
+    }
+    for (std::thread &worker: workers) {
+        worker.join();
+    }
+
+    for (const FileStatistics &file: batch.files) {
+        if (!file.error.empty()) {
+            batch.failed_files++;
+        }
+        batch.bytes += file.bytes;
+        batch.tokens += file.tokens;
+        batch.invalid_characters += file.invalid_characters;
+    }
+    batch.milliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    return batch;
+}
+
+void BatchTokenizer::tokenize_file(FileStatistics &statistics) const {
+    auto start = std::chrono::steady_clock::now();
+    try {
+        Predictor predictor(this->lexer, statistics.input_path);
+        LexemeTable lexemes{};
+        TokenBuffer tokens = predictor.tokenize_all(lexemes);
+        statistics.bytes = predictor.get_program().size();
+        statistics.tokens = tokens.size();
+        statistics.invalid_characters = tokens.diagnostics.invalid_count;
+        this->write_tokens(statistics, tokens, lexemes);
+    } catch (const std::exception &e) {
+        statistics.error = e.what();
+    }
+    auto end = std::chrono::steady_clock::now();
+    statistics.milliseconds = std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+class BatchTokenizer::FileSource : public InterleavedScanner::Source {
+public:
+    FileSource(const BatchTokenizer &tokenizer, std::vector<FileStatistics> &files,
+               std::atomic<std::size_t> &next_file) : tokenizer(tokenizer), files(files), next_file(next_file) {
+    }
+
+    bool next(std::string_view &text, TokenBuffer *&buffer) override {
+        for (std::size_t i = this->next_file.fetch_add(1); i < this->files.size(); i = this->next_file.fetch_add(1)) {
+            // a file that can't be read fails on its own, the lane takes the next one
+            auto file = std::make_unique<OpenFile>();
+            file->statistics = &this->files[i];
+            try {
+                file->source = std::make_unique<SourceBuffer>(file->statistics->input_path);
+                if (file->source->view().size() > std::numeric_limits<uint32_t>::max()) {
+                    throw std::runtime_error("Program is too large, token offsets are 32 bits: "
+                                             + file->statistics->input_path);
+                }
+            } catch (const std::exception &e) {
+                file->statistics->error = e.what();
+                continue;
+            }
+            text = file->source->view();
+            buffer = &file->tokens;
+            this->open_files.push_back(std::move(file));
+            return true;
+        }
+        return false;
+    }
+
+    void done(TokenBuffer *buffer) override {
+        auto it = std::find_if(this->open_files.begin(), this->open_files.end(),
+                               [buffer](const std::unique_ptr<OpenFile> &file) { return &file->tokens == buffer; });
+        this->tokenizer.finish_file(*(*it)->statistics, (*it)->source->view(), (*it)->tokens);
+        this->open_files.erase(it);
+    }
+
+private:
+    // a file in a lane
+    struct OpenFile {
+        FileStatistics *statistics{};
+        std::unique_ptr<SourceBuffer> source{};
+        TokenBuffer tokens{};
+    };
+
+    const BatchTokenizer &tokenizer;
+    std::vector<FileStatistics> &files;
+    std::atomic<std::size_t> &next_file;
+    std::vector<std::unique_ptr<OpenFile>> open_files{};
+};
+
+void BatchTokenizer::tokenize_files(std::vector<FileStatistics> &files, std::atomic<std::size_t> &next_file) const {
+    FileSource source(*this, files, next_file);
+    InterleavedScanner(this->lexer, this->lanes).tokenize_all(source);
+}
+
+void BatchTokenizer::finish_file(FileStatistics &statistics, std::string_view text, TokenBuffer &tokens) const {
+    statistics.bytes = text.size();
+    statistics.tokens = tokens.size();
+    statistics.invalid_characters = tokens.diagnostics.invalid_count;
+    // the interleaved loop has no lexeme table, the lexemes are interned once the tokens are known
+    LexemeTable lexemes{};
+    tokens.lexeme_ids.reserve(tokens.size());
+    for (std::size_t i = 0; i < tokens.size(); i++) {
+        tokens.lexeme_ids.push_back(lexemes.intern(text.substr(tokens.offsets[i], tokens.lengths[i])));
+    }
+    try {
+        this->write_tokens(statistics, tokens, lexemes);
+    } catch (const std::exception &e) {
+        statistics.error = e.what();
+    }
+}
+
+void BatchTokenizer::write_tokens(const FileStatistics &statistics, const TokenBuffer &tokens,
+                                  const LexemeTable &lexemes) const {
+    // one write per file
+    std::string contents{};
+    for (std::size_t i = 0; i < tokens.size(); i++) {
+        contents += this->lexer->get_kind_name(tokens.kinds[i]);
+        contents += ' ';
+        contents += std::to_string(tokens.lexeme_ids[i]);
+        contents += '\n';
+    }
+    write_file(statistics.output_path, contents);
+
+    // a repeated lexeme is written once
+    contents.clear();
+    for (uint32_t id = 0; id < lexemes.size(); id++) {
+        for (char c: lexemes.get_lexeme(id)) {
+            if (c == '\\') {
+                contents += "\\\\";
+            } else if (c == '\n') {
+                contents += "\\n";
+            } else {
+                contents += c;
+            }
+        }
+        contents += '\n';
+    }
+    write_file(get_lexemes_path(statistics.output_path), contents);
+}
+
+std::vector<std::string> BatchTokenizer::read_file_list(const std::string &list_path) {
+    std::ifstream infile(list_path);
+    if (!infile) {
+        throw std::runtime_error("Failed to open file: " + list_path);
+    }
+    std::vector<std::string> paths{};
+    std::string line{};
+    while (std::getline(infile, line)) {
+        if (!line.empty() && line.back() == '\r') {
+            line.pop_back();
+        }
+        if (!line.empty() && line[0] != '#') {
+            paths.push_back(line);
+        }
+    }
+    return paths;
+}
+
+std::string BatchTokenizer::get_output_path(const std::string &input_path, const std::string &output_directory) {
+    std::string name = input_path;
+    for (char &c: name) {
+        if (c == '/' || c == '\\') {
+            c = '_';
+        }
+    }
+    // "../a/b.txt" and "/a/b.txt" both give "a_b.txt"
+    name.erase(0, name.find_first_not_of("._"));
+    return (std::filesystem::path(output_directory) / (name + ".tokens")).string();
+}
+
+std::string BatchTokenizer::get_lexemes_path(const std::string &output_path) {
+    return std::filesystem::path(output_path).replace_extension(".lexemes").string();
+}
@@ -0,0 +1,99 @@
+#ifndef COMPILER_PROJECT_BATCHTOKENIZER_H
+#define COMPILER_PROJECT_BATCHTOKENIZER_H
+
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "LexemeTable.h"
+#include "Lexer.h"
+
+/**
+ * What tokenizing one file gave.
+ */
+struct FileStatistics {
+    std::string input_path{};
+    std::string output_path{};
+    std::size_t bytes{};
+    std::size_t tokens{};
+    std::size_t invalid_characters{};
+    // 0 if the file was scanned interleaved with others, the time of the loop isn't any one file's
+    double milliseconds{};
+    // empty if the file was tokenized, why it wasn't otherwise
+    std::string error{};
+};
+
+/**
+ * What tokenizing a list of files gave, the files are in the order of the list.
+ */
+struct BatchStatistics {
+    std::vector<FileStatistics> files{};
+    std::size_t failed_files{};
+    std::size_t bytes{};
+    std::size_t tokens{};
+    std::size_t invalid_characters{};
+    // the wall time of the whole batch
+    double milliseconds{};
+};
+
+/**
+ * This class tokenizes many program files with one lexer: the lexer is loaded once and shared (it is immutable),
+ * and the files are handed to a pool of worker threads, each file getting its own Predictor as a cursor.
+ * With more than one lane, every worker scans that many files at once with an InterleavedScanner instead,
+ * a lane whose file is done takes the next file of the list.
+ * The tokens of every file are written to a file of the output directory, one "name lexeme_id" line per token.
+ * The lexemes are interned per file, and the lexeme of every id is written next to the tokens (see get_lexemes_path).
+ */
+class BatchTokenizer {
+public:
+    // threads == 0 uses one thread per core, lanes is the number of files a thread scans at once
+    BatchTokenizer(std::shared_ptr<const Lexer> lexer, unsigned int threads, std::size_t lanes = 1);
+
+    /**
+     * Tokenizes the files, a file that can't be read or written is recorded as failed and the others go on.
+     * Throws std::runtime_error if the output directory can't be created.
+     */
+    [[nodiscard]] BatchStatistics run(const std::vector<std::string> &input_paths,
+                                      const std::string &output_directory) const;
+
+    /**
+     * Reads a list of paths, one per line (empty lines and lines starting with '#' are skipped).
+     */
+    static std::vector<std::string> read_file_list(const std::string &list_path);
+
+    /**
+     * Returns the output file of an input file: its path with the separators replaced by '_', and ".tokens".
+     */
+    static std::string get_output_path(const std::string &input_path, const std::string &output_directory);
+
+    /**
+     * Returns the lexemes file of an output file: its path with ".lexemes" instead of ".tokens".
+     * Line i is the lexeme of id i, with its backslashes and new lines escaped as \\ and \n.
+     */
+    static std::string get_lexemes_path(const std::string &output_path);
+
+private:
+    std::shared_ptr<const Lexer> lexer{};
+    unsigned int threads{};
+    std::size_t lanes{};
+
+    // tokenizes one file into its output file
+    void tokenize_file(FileStatistics &statistics) const;
+
+    // the files of the list an InterleavedScanner takes, the next one is the next unclaimed file
+    class FileSource;
+
+    // tokenizes the unclaimed files with an InterleavedScanner until none is left, every one into its output file
+    void tokenize_files(std::vector<FileStatistics> &files, std::atomic<std::size_t> &next_file) const;
+
+    // records what scanning a file gave, interns its lexemes and writes its output files
+    void finish_file(FileStatistics &statistics, std::string_view text, TokenBuffer &tokens) const;
+
+    // writes the token names and lexeme ids of a file to its output file, and its lexemes to its lexemes file
+    void write_tokens(const FileStatistics &statistics, const TokenBuffer &tokens, const LexemeTable &lexemes) const;
+};
+
+
+#endif
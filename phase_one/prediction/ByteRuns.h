@@ -0,0 +1,197 @@
+#ifndef COMPILER_PROJECT_BYTERUNS_H
+#define COMPILER_PROJECT_BYTERUNS_H
+
+
+#include <cstdint>
+
+#if defined(__AVX2__) || defined(__SSE2__)
+
+#include <immintrin.h>
+
+#endif
+
+/**
+ * Kernels that skip a run of bytes of one class, 32 (AVX2) or 16 (SSE2) bytes at a time with a scalar fallback.
+ * Every kernel returns a pointer to the first byte in [p, end) that is not in its class (or end).
+ *
+ * The classes are either one of the fixed run kinds or a set of a few byte ranges (ByteRanges), the accelerator of
+ * a state that loops on everything but a few exit bytes (see CompiledDFA::get_accelerator).
+ */
+namespace ByteRuns {
+    // the classes of bytes a run can be made of
+    enum RunKind : uint8_t {
+        NONE = 0,
+        // ' ', '\t', '\n', '\v', '\f', '\r' (std::isspace in the "C" locale)
+        WHITE_SPACE,
+        // '0' .. '9'
+        DIGITS,
+        // '0' .. '9', 'A' .. 'Z', 'a' .. 'z'
+        ALPHANUMERIC,
+        // the ByteRanges of the state, they are skipped with the ByteRanges overload of skip
+        RANGES
+    };
+
+    // the most ranges a ByteRanges has, every range costs two compares per block
+    constexpr int MAX_RANGES = 4;
+
+    // the bytes of the ranges [low[i], high[i]], i < count
+    struct ByteRanges {
+        uint8_t count;
+        uint8_t low[MAX_RANGES];
+        uint8_t high[MAX_RANGES];
+
+        [[nodiscard]] inline bool contains(unsigned char c) const {
+            for (int i = 0; i < this->count; i++) {
+                if (c >= this->low[i] && c <= this->high[i]) {
+                    return true;
+                }
+            }
+            return false;
+        }
+    };
+
+    inline bool is_white_space(unsigned char c) {
+        return c == ' ' || (c >= '\t' && c <= '\r');
+    }
+
+    inline bool is_digit(unsigned char c) {
+        return c >= '0' && c <= '9';
+    }
+
+    inline bool is_alphanumeric(unsigned char c) {
+        return is_digit(c) || ((c | 0x20) >= 'a' && (c | 0x20) <= 'z');
+    }
+
+    inline bool is_in_run(RunKind kind, unsigned char c) {
+        switch (kind) {
+            case WHITE_SPACE:
+                return is_white_space(c);
+            case DIGITS:
+                return is_digit(c);
+            case ALPHANUMERIC:
+                return is_alphanumeric(c);
+            default:
+                return false;
+        }
+    }
+
+#if defined(__AVX2__)
+    // signed byte compares are fine here, bytes >= 0x80 are negative so they are never in a class
+    inline __m256i in_range(__m256i x, char low, char high) {
+        return _mm256_and_si256(_mm256_cmpgt_epi8(x, _mm256_set1_epi8((char) (low - 1))),
+                                _mm256_cmpgt_epi8(_mm256_set1_epi8((char) (high + 1)), x));
+    }
+
+    inline __m256i class_mask(RunKind kind, __m256i x) {
+        switch (kind) {
+            case WHITE_SPACE:
+                return _mm256_or_si256(_mm256_cmpeq_epi8(x, _mm256_set1_epi8(' ')), in_range(x, '\t', '\r'));
+            case DIGITS:
+                return in_range(x, '0', '9');
+            default:
+                return _mm256_or_si256(in_range(x, '0', '9'),
+                                       in_range(_mm256_or_si256(x, _mm256_set1_epi8(0x20)), 'a', 'z'));
+        }
+    }
+#elif defined(__SSE2__)
+    inline __m128i in_range(__m128i x, char low, char high) {
+        return _mm_and_si128(_mm_cmpgt_epi8(x, _mm_set1_epi8((char) (low - 1))),
+                             _mm_cmplt_epi8(x, _mm_set1_epi8((char) (high + 1))));
+    }
+
+    inline __m128i class_mask(RunKind kind, __m128i x) {
+        switch (kind) {
+            case WHITE_SPACE:
+                return _mm_or_si128(_mm_cmpeq_epi8(x, _mm_set1_epi8(' ')), in_range(x, '\t', '\r'));
+            case DIGITS:
+                return in_range(x, '0', '9');
+            default:
+                return _mm_or_si128(in_range(x, '0', '9'), in_range(_mm_or_si128(x, _mm_set1_epi8(0x20)), 'a', 'z'));
+        }
+    }
+#endif
+
+    /**
+     * Skips the bytes of a run kind starting at p.
+     */
+    inline const char *skip(RunKind kind, const char *p, const char *end) {
+#if defined(__AVX2__)
+        while (end - p >= 32) {
+            __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p));
+            auto outside = ~(uint32_t) _mm256_movemask_epi8(class_mask(kind, x));
+            if (outside != 0) {
+                return p + __builtin_ctz(outside);
+            }
+            p += 32;
+        }
+#elif defined(__SSE2__)
+        while (end - p >= 16) {
+            __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+            auto outside = ~(uint32_t) _mm_movemask_epi8(class_mask(kind, x)) & 0xFFFFu;
+            if (outside != 0) {
+                return p + __builtin_ctz(outside);
+            }
+            p += 16;
+        }
+#endif
+        while (p < end && is_in_run(kind, static_cast<unsigned char>(*p))) {
+            p++;
+        }
+        return p;
+    }
+
+    /**
+     * Skips the bytes of a set of ranges starting at p. A byte x is in [low, high] if the unsigned x - low is at most
+     * high - low, which costs a subtraction, a min and a compare per range.
+     */
+    inline const char *skip(const ByteRanges &ranges, const char *p, const char *end) {
+#if defined(__AVX2__)
+        __m256i lows[MAX_RANGES];
+        __m256i spans[MAX_RANGES];
+        for (int i = 0; i < ranges.count; i++) {
+            lows[i] = _mm256_set1_epi8((char) ranges.low[i]);
+            spans[i] = _mm256_set1_epi8((char) (ranges.high[i] - ranges.low[i]));
+        }
+        while (end - p >= 32) {
+            __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p));
+            __m256i inside = _mm256_setzero_si256();
+            for (int i = 0; i < ranges.count; i++) {
+                __m256i offset = _mm256_sub_epi8(x, lows[i]);
+                inside = _mm256_or_si256(inside, _mm256_cmpeq_epi8(_mm256_min_epu8(offset, spans[i]), offset));
+            }
+            auto outside = ~(uint32_t) _mm256_movemask_epi8(inside);
+            if (outside != 0) {
+                return p + __builtin_ctz(outside);
+            }
+            p += 32;
+        }
+#elif defined(__SSE2__)
+        __m128i lows[MAX_RANGES];
+        __m128i spans[MAX_RANGES];
+        for (int i = 0; i < ranges.count; i++) {
+            lows[i] = _mm_set1_epi8((char) ranges.low[i]);
+            spans[i] = _mm_set1_epi8((char) (ranges.high[i] - ranges.low[i]));
+        }
+        while (end - p >= 16) {
+            __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+            __m128i inside = _mm_setzero_si128();
+            for (int i = 0; i < ranges.count; i++) {
+                __m128i offset = _mm_sub_epi8(x, lows[i]);
+                inside = _mm_or_si128(inside, _mm_cmpeq_epi8(_mm_min_epu8(offset, spans[i]), offset));
+            }
+            auto outside = ~(uint32_t) _mm_movemask_epi8(inside) & 0xFFFFu;
+            if (outside != 0) {
+                return p + __builtin_ctz(outside);
+            }
+            p += 16;
+        }
+#endif
+        while (p < end && ranges.contains(static_cast<unsigned char>(*p))) {
+            p++;
+        }
+        return p;
+    }
+}
+
+
+#endif
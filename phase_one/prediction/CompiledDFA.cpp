@@ -0,0 +1,322 @@
+#include <algorithm>
+#include <cctype>
+#include <limits>
+#include <map>
+#include <queue>
+#include <stdexcept>
+#include "CompiledDFA.h"
+
+CompiledDFA::CompiledDFA(std::shared_ptr<Automaton> &a, const Types::state_set_t &dead_states) {
+    auto ids_count = (int32_t) a->get_states().size();
+    for (const std::shared_ptr<State> &state_ptr: a->get_states()) {
+        if (state_ptr->getId() < 0 || state_ptr->getId() >= ids_count) {
+            throw std::runtime_error("Can't compile the DFA, state ids must be in the range [0, states count)");
+        }
+    }
+
+    // matrix_representation indexes the symbols in their sorted order
+    std::vector<std::vector<std::shared_ptr<State>>> matrix = a->matrix_representation();
+    std::vector<std::string> symbols(a->get_alphabets().begin(), a->get_alphabets().end());
+    std::sort(symbols.begin(), symbols.end());
+
+    // the lexer modes, the initial one first: the start state goes to the entry state of a mode on its symbol.
+    // Without modes the start state is the entry of the initial mode.
+    std::vector<std::size_t> mode_symbols{};
+    for (std::size_t i = 0; i < symbols.size(); i++) {
+        if (symbols[i].rfind(Automaton::MODE_SYMBOL_PREFIX, 0) == 0) {
+            mode_symbols.push_back(i);
+        }
+    }
+    std::stable_partition(mode_symbols.begin(), mode_symbols.end(), [&symbols](std::size_t i) {
+        return symbols[i] == Automaton::MODE_SYMBOL_PREFIX + Automaton::INITIAL_MODE;
+    });
+    std::vector<std::shared_ptr<State>> entry_states{};
+    if (mode_symbols.empty()) {
+        this->mode_names.push_back(Automaton::INITIAL_MODE);
+        entry_states.push_back(a->get_start());
+    }
+    for (std::size_t i: mode_symbols) {
+        const std::shared_ptr<State> &entry_ptr = matrix[a->get_start()->getId()][i];
+        if (entry_ptr == nullptr) {
+            throw std::runtime_error("Can't compile the DFA, the start state doesn't enter the mode " + symbols[i]);
+        }
+        this->mode_names.push_back(symbols[i].substr(Automaton::MODE_SYMBOL_PREFIX.size()));
+        entry_states.push_back(entry_ptr);
+    }
+    if (this->mode_names.front() != Automaton::INITIAL_MODE) {
+        throw std::runtime_error("Can't compile the DFA, it has lexer modes but no " + Automaton::INITIAL_MODE);
+    }
+
+    // the dead states get no row, every transition to them is the DEAD sentinel.
+    // The other states keep the order of their ids, the entry states always have a row.
+    std::vector<bool> dead(ids_count, false);
+    for (const std::shared_ptr<State> &state_ptr: dead_states) {
+        dead[state_ptr->getId()] = true;
+    }
+    for (const std::shared_ptr<State> &entry_ptr: entry_states) {
+        dead[entry_ptr->getId()] = false;
+    }
+    std::vector<int32_t> rows(ids_count, DEAD);
+    std::vector<int32_t> row_ids{};
+    for (int32_t id = 0; id < ids_count; id++) {
+        if (!dead[id]) {
+            rows[id] = (int32_t) row_ids.size();
+            row_ids.push_back(id);
+        }
+    }
+    this->states_count = (int32_t) row_ids.size();
+    this->state_ids = row_ids;
+    for (const std::shared_ptr<State> &entry_ptr: entry_states) {
+        this->entries.push_back(rows[entry_ptr->getId()]);
+    }
+    this->start = this->entries.front();
+
+    // token kinds, numbered in the sorted order of the tokens names
+    std::map<std::string, int32_t> kind_ids{};
+    for (const auto &pair: a->get_tokens()) {
+        for (const std::string &token: pair.second) {
+            kind_ids.emplace(token, 0);
+        }
+    }
+    for (auto &pair: kind_ids) {
+        pair.second = (int32_t) this->kind_names.size();
+        this->kind_names.push_back(pair.first);
+    }
+
+    // every byte starts as invalid in every state, white spaces separate tokens unless the state reads them
+    std::vector<int32_t> byte_table(static_cast<std::size_t>(this->states_count) << 8, INVALID);
+    for (int32_t state = 0; state < this->states_count; state++) {
+        int32_t *row = byte_table.data() + (static_cast<std::size_t>(state) << 8);
+        for (std::size_t i = 0; i < symbols.size(); i++) {
+            if (symbols[i].size() != 1) {
+                continue;
+            }
+            const std::shared_ptr<State> &next_state_ptr = matrix[row_ids[state]][i];
+            auto c = static_cast<unsigned char>(symbols[i][0]);
+            row[c] = next_state_ptr == nullptr ? DEAD : rows[next_state_ptr->getId()];
+        }
+        for (int c = 0; c < 256; c++) {
+            if (std::isspace(c) && row[c] < 0) {
+                row[c] = SEPARATOR;
+            }
+        }
+    }
+
+    compress_columns(byte_table);
+    find_run_kinds();
+
+    // the resolved token of the accepting states
+    this->accept_kinds.assign(this->states_count, NO_TOKEN);
+    for (const std::shared_ptr<State> &state_ptr: a->get_accepting_states()) {
+        auto it = kind_ids.find(state_ptr->getToken());
+        if (it != kind_ids.end() && rows[state_ptr->getId()] != DEAD) {
+            this->accept_kinds[rows[state_ptr->getId()]] = it->second;
+        }
+    }
+
+    // the mode a token enters: its accepting states go to the entry state of the mode on the symbol of the mode
+    this->kind_modes.assign(this->kind_names.size(), KEEP_MODE);
+    for (int32_t state = 0; state < this->states_count; state++) {
+        int32_t kind = this->accept_kinds[state];
+        for (std::size_t mode = 0; mode < mode_symbols.size() && kind != NO_TOKEN; mode++) {
+            const std::shared_ptr<State> &next_state_ptr = matrix[row_ids[state]][mode_symbols[mode]];
+            if (next_state_ptr != nullptr && next_state_ptr->getId() == entry_states[mode]->getId()) {
+                this->kind_modes[kind] = (int32_t) mode;
+            }
+        }
+    }
+
+    // a mode whose entry state reads none of the white spaces skips them before a token
+    for (int32_t entry: this->entries) {
+        bool skips = true;
+        for (int c = 0; c < 256; c++) {
+            if (ByteRuns::is_white_space(c) && this->next(entry, c) != SEPARATOR) {
+                skips = false;
+            }
+        }
+        this->white_space_skips.push_back(skips ? 1 : 0);
+    }
+}
+
+void CompiledDFA::compress_columns(const std::vector<int32_t> &byte_table) {
+    // bytes whose columns are equal over all the states are one class
+    std::map<std::vector<int32_t>, uint8_t> classes{};
+    std::vector<std::vector<int32_t>> columns{};
+    for (int c = 0; c < 256; c++) {
+        std::vector<int32_t> column(this->states_count);
+        for (int32_t state = 0; state < this->states_count; state++) {
+            column[state] = byte_table[(static_cast<std::size_t>(state) << 8) | c];
+        }
+        auto it = classes.find(column);
+        if (it == classes.end()) {
+            it = classes.emplace(column, (uint8_t) columns.size()).first;
+            columns.push_back(column);
+        }
+        this->byte_classes[c] = it->second;
+    }
+
+    this->classes_count = (int32_t) columns.size();
+    std::vector<int32_t> table(static_cast<std::size_t>(this->states_count) * this->classes_count, INVALID);
+    for (int32_t state = 0; state < this->states_count; state++) {
+        for (int32_t byte_class = 0; byte_class < this->classes_count; byte_class++) {
+            table[static_cast<std::size_t>(state) * this->classes_count + byte_class] = columns[byte_class][state];
+        }
+    }
+
+    // the narrowest cells that hold every state, the sentinels are negative so they always fit
+    if (this->states_count <= std::numeric_limits<int8_t>::max() + 1) {
+        this->state_bytes = 1;
+        this->table_8 = TransitionTable<int8_t>(table, this->states_count, this->classes_count);
+    } else if (this->states_count <= std::numeric_limits<int16_t>::max() + 1) {
+        this->state_bytes = 2;
+        this->table_16 = TransitionTable<int16_t>(table, this->states_count, this->classes_count);
+    } else {
+        this->state_bytes = 4;
+        this->table_32 = TransitionTable<int32_t>(table, this->states_count, this->classes_count);
+    }
+}
+
+void CompiledDFA::find_run_kinds() {
+    this->run_kinds.assign(this->states_count, ByteRuns::NONE);
+    this->accelerators.assign(this->states_count, ByteRuns::ByteRanges{});
+    for (int32_t state = 0; state < this->states_count; state++) {
+        // the widest run first, alphanumeric runs contain the digit runs
+        int run_bytes = 0;
+        for (ByteRuns::RunKind kind: {ByteRuns::ALPHANUMERIC, ByteRuns::DIGITS}) {
+            bool loops = true;
+            run_bytes = 0;
+            for (int c = 0; c < 256 && loops; c++) {
+                if (ByteRuns::is_in_run(kind, c)) {
+                    loops = this->next(state, c) == state;
+                    run_bytes++;
+                }
+            }
+            if (loops) {
+                this->run_kinds[state] = kind;
+                break;
+            }
+            run_bytes = 0;
+        }
+
+        // an accelerator: the state loops on a few ranges of bytes (e.g. everything but '*' in a comment),
+        // the scanner searches for the bytes that leave it instead of reading the table byte by byte.
+        // It replaces the run kind if it skips more bytes. A state that loops on a handful of bytes (the prefix of
+        // a keyword) rarely has a run worth the search.
+        ByteRuns::ByteRanges ranges{};
+        bool fits = true;
+        int loop_bytes = 0;
+        for (int c = 0; c < 256 && fits; c++) {
+            if (this->next(state, c) != state) {
+                continue;
+            }
+            loop_bytes++;
+            if (ranges.count > 0 && ranges.high[ranges.count - 1] == c - 1) {
+                ranges.high[ranges.count - 1] = (uint8_t) c;
+            } else if (ranges.count < ByteRuns::MAX_RANGES) {
+                ranges.low[ranges.count] = (uint8_t) c;
+                ranges.high[ranges.count] = (uint8_t) c;
+                ranges.count++;
+            } else {
+                fits = false;
+            }
+        }
+        if (fits && loop_bytes >= MIN_ACCELERATED_BYTES && loop_bytes > run_bytes) {
+            this->run_kinds[state] = ByteRuns::RANGES;
+            this->accelerators[state] = ranges;
+        }
+    }
+}
+
+Types::state_set_t CompiledDFA::find_dead_states(const std::shared_ptr<Automaton> &a) {
+    auto ids_count = (int32_t) a->get_states().size();
+    std::vector<std::shared_ptr<State>> states(ids_count);
+    for (const std::shared_ptr<State> &state_ptr: a->get_states()) {
+        states[state_ptr->getId()] = state_ptr;
+    }
+
+    // reverse the byte transitions, the other symbols never reach the table
+    std::vector<std::vector<std::shared_ptr<State>>> matrix = a->matrix_representation();
+    std::vector<std::string> symbols(a->get_alphabets().begin(), a->get_alphabets().end());
+    std::sort(symbols.begin(), symbols.end());
+    std::vector<std::vector<int32_t>> predecessors(ids_count);
+    for (int32_t state = 0; state < ids_count; state++) {
+        for (std::size_t i = 0; i < symbols.size(); i++) {
+            if (symbols[i].size() == 1 && matrix[state][i] != nullptr) {
+                predecessors[matrix[state][i]->getId()].push_back(state);
+            }
+        }
+    }
+
+    // breadth first search from the accepting states over the reversed transitions,
+    // the states it doesn't reach can't lead to an accepting state whatever the input is
+    std::vector<bool> live(ids_count, false);
+    std::queue<int32_t> queue{};
+    for (const std::shared_ptr<State> &state_ptr: a->get_accepting_states()) {
+        if (!live[state_ptr->getId()]) {
+            live[state_ptr->getId()] = true;
+            queue.push(state_ptr->getId());
+        }
+    }
+    while (!queue.empty()) {
+        int32_t state = queue.front();
+        queue.pop();
+        for (int32_t predecessor: predecessors[state]) {
+            if (!live[predecessor]) {
+                live[predecessor] = true;
+                queue.push(predecessor);
+            }
+        }
+    }
+
+    Types::state_set_t dead_states{};
+    for (int32_t state = 0; state < ids_count; state++) {
+        if (!live[state]) {
+            dead_states.insert(states[state]);
+        }
+    }
+    return dead_states;
+}
+
+int32_t CompiledDFA::get_start() const {
+    return this->start;
+}
+
+int32_t CompiledDFA::get_modes_count() const {
+    return (int32_t) this->mode_names.size();
+}
+
+const std::string &CompiledDFA::get_mode_name(int32_t mode) const {
+    return this->mode_names[mode];
+}
+
+int32_t CompiledDFA::get_mode_id(const std::string &name) const {
+    auto it = std::find(this->mode_names.begin(), this->mode_names.end(), name);
+    if (it == this->mode_names.end()) {
+        throw std::runtime_error("Unknown lexer mode: " + name);
+    }
+    return (int32_t) (it - this->mode_names.begin());
+}
+
+int32_t CompiledDFA::get_classes_count() const {
+    return this->classes_count;
+}
+
+std::size_t CompiledDFA::get_table_size_bytes() const {
+    return this->table_8.get_size_bytes() + this->table_16.get_size_bytes() + this->table_32.get_size_bytes();
+}
+
+int32_t CompiledDFA::get_states_count() const {
+    return this->states_count;
+}
+
+int32_t CompiledDFA::get_state_id(int32_t state) const {
+    return this->state_ids[state];
+}
+
+const std::string &CompiledDFA::get_kind_name(int32_t kind) const {
+    return this->kind_names[kind];
+}
+
+int32_t CompiledDFA::get_kinds_count() const {
+    return (int32_t) this->kind_names.size();
+}
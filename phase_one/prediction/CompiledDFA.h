@@ -0,0 +1,268 @@
+#ifndef COMPILER_PROJECT_COMPILEDDFA_H
+#define COMPILER_PROJECT_COMPILEDDFA_H
+
+
+#include <cstdint>
+#include <string>
+#include <type_traits>
+#include <vector>
+#include "../automaton/Automaton.h"
+#include "ByteRuns.h"
+#include "TransitionTable.h"
+
+/**
+ * This class is a compiled (table driven) form of the final DFA used by the scanner.
+ * The transitions are stored in a flat table indexed by [state][class], so reading a character
+ * costs two array loads instead of building, hashing and copying a (state, symbol) key.
+ * The cells of the table are the narrowest type the states fit in (int8_t, int16_t or int32_t), the scanners are
+ * templates on that type (see get_table), so the table of most rules is a few KiB and stays in L1.
+ *
+ * Bytes are grouped into equivalence classes: two bytes share a class if every state goes to the same place
+ * using either of them (e.g. most letters and digits), which shrinks the rows from 256 entries to a few dozens.
+ *
+ * Negative entries in the table are sentinels, the scanner has to check them before using the entry as a state.
+ */
+class CompiledDFA {
+public:
+    // the transition leads to a dead state, the current token can't be extended any more.
+    static constexpr int32_t DEAD = -1;
+
+    // the byte isn't one of the alphabets of the automaton.
+    static constexpr int32_t INVALID = -2;
+
+    // the byte is a white space, it separates tokens.
+    static constexpr int32_t SEPARATOR = -3;
+
+    // no token is accepted at this state.
+    static constexpr int32_t NO_TOKEN = -1;
+
+    // the lexer mode every scan starts in.
+    static constexpr int32_t INITIAL_MODE = 0;
+
+    // the token doesn't change the lexer mode.
+    static constexpr int32_t KEEP_MODE = -1;
+
+    // a state gets an accelerator only if it loops on this many bytes at least.
+    static constexpr int MIN_ACCELERATED_BYTES = 32;
+
+    /**
+     * Compiles a DFA into a transition table.
+     * The token of every accepting state must already be resolved (see LexicalRulesHandler::export_automata),
+     * it is the token the state accepts.
+     *
+     * If the DFA has lexer modes (see LexicalRulesHandler::export_automata), its start state only enters them,
+     * and every mode gets the entry state its symbol leads to.
+     *
+     * @param a           the DFA, its states must have the ids 0..n-1 (as given by Automaton::give_new_ids_all)
+     * @param dead_states the states that can't lead to an accepting state, they get no row and the transitions to
+     *                    them become DEAD, so the rows are numbered apart from the state ids
+     */
+    CompiledDFA(std::shared_ptr<Automaton> &a, const Types::state_set_t &dead_states);
+
+    /**
+     * Finds the states of a DFA that can't reach an accepting state through any path (reverse reachability from
+     * the accepting states), the scanner can stop at the first byte that leads to one of them.
+     */
+    static Types::state_set_t find_dead_states(const std::shared_ptr<Automaton> &a);
+
+    /**
+     * Returns the next state (or a negative sentinel) from a state using a byte.
+     */
+    [[nodiscard]] inline int32_t next(int32_t state, unsigned char c) const {
+        switch (this->state_bytes) {
+            case 1:
+                return this->next<int8_t>(state, c);
+            case 2:
+                return this->next<int16_t>(state, c);
+            default:
+                return this->next<int32_t>(state, c);
+        }
+    }
+
+    /**
+     * Returns the next state like next, T must be the cell type of the table (see get_state_bytes).
+     */
+    template<typename T>
+    [[nodiscard]] inline int32_t next(int32_t state, unsigned char c) const {
+        return this->get_table<T>().next(state, this->byte_classes[c]);
+    }
+
+    /**
+     * Returns the size of a cell of the table: 1, 2 or 4 bytes for int8_t, int16_t or int32_t.
+     */
+    [[nodiscard]] inline int32_t get_state_bytes() const {
+        return this->state_bytes;
+    }
+
+    /**
+     * Returns the table, T must be its cell type (see get_state_bytes).
+     */
+    template<typename T>
+    [[nodiscard]] inline const TransitionTable<T> &get_table() const {
+        if constexpr (std::is_same_v<T, int8_t>) {
+            return this->table_8;
+        } else if constexpr (std::is_same_v<T, int16_t>) {
+            return this->table_16;
+        } else {
+            return this->table_32;
+        }
+    }
+
+    /**
+     * Returns the size of the table in bytes.
+     */
+    [[nodiscard]] std::size_t get_table_size_bytes() const;
+
+    /**
+     * Returns the equivalence class of a byte.
+     */
+    [[nodiscard]] inline uint8_t get_byte_class(unsigned char c) const {
+        return this->byte_classes[c];
+    }
+
+    /**
+     * Returns the number of byte equivalence classes (columns) of the table.
+     */
+    [[nodiscard]] int32_t get_classes_count() const;
+
+    /**
+     * Returns the run of bytes a state loops on (ByteRuns::NONE if it doesn't loop on a whole run),
+     * the scanner can skip such a run with ByteRuns::skip instead of reading it byte by byte.
+     */
+    [[nodiscard]] inline ByteRuns::RunKind get_run_kind(int32_t state) const {
+        return static_cast<ByteRuns::RunKind>(this->run_kinds[state]);
+    }
+
+    /**
+     * Returns the byte ranges a state loops on, if its run kind is ByteRuns::RANGES: the state goes back to itself on
+     * every byte of them and leaves on every other byte.
+     */
+    [[nodiscard]] inline const ByteRuns::ByteRanges &get_accelerator(int32_t state) const {
+        return this->accelerators[state];
+    }
+
+    /**
+     * Skips the run a state loops on from p, its run kind must not be ByteRuns::NONE.
+     */
+    [[nodiscard]] inline const char *skip_run(int32_t state, ByteRuns::RunKind run, const char *p,
+                                              const char *end) const {
+        if (run == ByteRuns::RANGES) {
+            return ByteRuns::skip(this->accelerators[state], p, end);
+        }
+        return ByteRuns::skip(run, p, end);
+    }
+
+    /**
+     * Returns the start state, the entry state of the initial mode.
+     */
+    [[nodiscard]] int32_t get_start() const;
+
+    /**
+     * Returns the state a token starts from in a lexer mode, switching modes is switching entry states.
+     */
+    [[nodiscard]] inline int32_t get_entry(int32_t mode) const {
+        return this->entries[mode];
+    }
+
+    /**
+     * Returns the mode the scanner goes on in after a token of a kind, KEEP_MODE if the kind doesn't change it.
+     */
+    [[nodiscard]] inline int32_t get_kind_mode(int32_t kind) const {
+        return this->kind_modes[kind];
+    }
+
+    /**
+     * Checks if the white spaces before a token separate it from the previous one in a mode,
+     * they don't in a mode that reads them (e.g. the body of a string).
+     */
+    [[nodiscard]] inline bool skips_white_space(int32_t mode) const {
+        return this->white_space_skips[mode] != 0;
+    }
+
+    /**
+     * Returns the number of lexer modes, 1 if the rules have none.
+     */
+    [[nodiscard]] int32_t get_modes_count() const;
+
+    /**
+     * Returns the name of a lexer mode.
+     */
+    [[nodiscard]] const std::string &get_mode_name(int32_t mode) const;
+
+    /**
+     * Returns the id of a lexer mode by name, throws if there is no such mode.
+     */
+    [[nodiscard]] int32_t get_mode_id(const std::string &name) const;
+
+    /**
+     * Returns the number of states (rows) of the table.
+     */
+    [[nodiscard]] int32_t get_states_count() const;
+
+    /**
+     * Returns the id of the automaton state a row of the table was compiled from.
+     */
+    [[nodiscard]] int32_t get_state_id(int32_t state) const;
+
+    /**
+     * Returns the token kind a state accepts, NO_TOKEN if it isn't accepting.
+     */
+    [[nodiscard]] inline int32_t get_accept_kind(int32_t state) const {
+        return this->accept_kinds[state];
+    }
+
+    /**
+     * Returns the name of a token kind.
+     */
+    [[nodiscard]] const std::string &get_kind_name(int32_t kind) const;
+
+    /**
+     * Returns the number of token kinds.
+     */
+    [[nodiscard]] int32_t get_kinds_count() const;
+
+private:
+    // the table with the cells of state_bytes bytes, the other ones are empty
+    TransitionTable<int8_t> table_8{};
+    TransitionTable<int16_t> table_16{};
+    TransitionTable<int32_t> table_32{};
+    int32_t state_bytes{};
+
+    // maps every byte to its equivalence class
+    uint8_t byte_classes[256]{};
+    int32_t classes_count{};
+
+    // the token kind every state accepts
+    std::vector<int32_t> accept_kinds{};
+
+    // names of the token kinds, indexed by kind id
+    std::vector<std::string> kind_names{};
+
+    // the run kind every state loops on
+    std::vector<uint8_t> run_kinds{};
+    // the byte ranges of the states of the RANGES run kind (empty for the others)
+    std::vector<ByteRuns::ByteRanges> accelerators{};
+
+    int32_t start{};
+    int32_t states_count{};
+    // the automaton state id of every row
+    std::vector<int32_t> state_ids{};
+
+    // the entry state of every lexer mode, the initial mode first
+    std::vector<int32_t> entries{};
+    std::vector<std::string> mode_names{};
+    // the mode every token kind enters (KEEP_MODE if none)
+    std::vector<int32_t> kind_modes{};
+    // whether every mode skips the white spaces before a token
+    std::vector<uint8_t> white_space_skips{};
+
+    // groups the bytes of a [state][byte] table into equivalence classes and fills the [state][class] table of the
+    // narrowest cells
+    void compress_columns(const std::vector<int32_t> &byte_table);
+
+    // finds the widest run every state loops on, or the ranges it loops on if they are few enough
+    void find_run_kinds();
+};
+
+
+#endif
@@ -0,0 +1,56 @@
+#ifndef COMPILER_PROJECT_DIAGNOSTICS_H
+#define COMPILER_PROJECT_DIAGNOSTICS_H
+
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * A run of invalid characters the scanner skipped, as an offset and a length into the program.
+ */
+struct Diagnostic {
+    uint32_t offset{};
+    uint32_t length{};
+};
+
+/**
+ * The errors found while scanning a program, in the order of their offsets.
+ * Consecutive invalid characters are merged into one record, so a long run of garbage costs one record.
+ */
+struct Diagnostics {
+    std::vector<Diagnostic> records{};
+
+    // the number of invalid characters in all the records
+    std::size_t invalid_count{};
+
+    [[nodiscard]] std::size_t size() const {
+        return this->records.size();
+    }
+
+    [[nodiscard]] bool empty() const {
+        return this->records.empty();
+    }
+
+    // records length invalid characters at offset, merging them with the last record if they follow it.
+    void add(std::size_t offset, std::size_t length) {
+        if (!this->records.empty() && this->records.back().offset + this->records.back().length == offset) {
+            this->records.back().length += (uint32_t) length;
+        } else {
+            this->records.push_back(Diagnostic{(uint32_t) offset, (uint32_t) length});
+        }
+        this->invalid_count += length;
+    }
+
+    // appends the records of other that start at from_offset or after it.
+    void append(const Diagnostics &other, std::size_t from_offset = 0) {
+        for (const Diagnostic &record: other.records) {
+            if (record.offset >= from_offset) {
+                this->add(record.offset, record.length);
+            }
+        }
+    }
+};
+
+
+#endif
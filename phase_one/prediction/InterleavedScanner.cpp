@@ -0,0 +1,167 @@
+#include <algorithm>
+#include <utility>
+#include "InterleavedScanner.h"
+
+InterleavedScanner::InterleavedScanner(std::shared_ptr<const Lexer> lexer, std::size_t lanes) {
+    this->lexer = std::move(lexer);
+    this->lanes = std::clamp<std::size_t>(lanes, 1, MAX_LANES);
+}
+
+namespace {
+    // the programs of a vector, in order
+    class VectorSource : public InterleavedScanner::Source {
+    public:
+        VectorSource(const std::vector<std::string_view> &texts, std::vector<TokenBuffer> &buffers)
+                : texts(texts), buffers(buffers) {
+        }
+
+        bool next(std::string_view &text, TokenBuffer *&buffer) override {
+            if (this->next_text == this->texts.size()) {
+                return false;
+            }
+            text = this->texts[this->next_text];
+            buffer = &this->buffers[this->next_text];
+            this->next_text++;
+            return true;
+        }
+
+        void done(TokenBuffer *) override {
+        }
+
+    private:
+        const std::vector<std::string_view> &texts;
+        std::vector<TokenBuffer> &buffers;
+        std::size_t next_text{};
+    };
+}
+
+std::vector<TokenBuffer> InterleavedScanner::tokenize_all(const std::vector<std::string_view> &texts) const {
+    std::vector<TokenBuffer> buffers(texts.size());
+    VectorSource source(texts, buffers);
+    this->tokenize_all(source);
+    return buffers;
+}
+
+void InterleavedScanner::tokenize_all(Source &source) const {
+    switch (this->lexer->get_dfa().get_state_bytes()) {
+        case 1:
+            this->scan_all<int8_t>(source);
+            break;
+        case 2:
+            this->scan_all<int16_t>(source);
+            break;
+        default:
+            this->scan_all<int32_t>(source);
+            break;
+    }
+}
+
+template<typename T>
+void InterleavedScanner::scan_all(Source &source) const {
+    const CompiledDFA &dfa = this->lexer->get_dfa();
+    Lane lanes_of_loop[MAX_LANES]{};
+    std::size_t lanes_count = 0;
+    // puts the next program that has a token into a lane, returns false if there is none
+    auto open_lane = [&](Lane &lane) {
+        lane = Lane{};
+        while (source.next(lane.text, lane.buffer)) {
+            lane.buffer->reserve(lane.text.size() / 8);
+            lane.mode = CompiledDFA::INITIAL_MODE;
+            if (this->start_token(lane)) {
+                return true;
+            }
+            // a program of white spaces only
+            source.done(lane.buffer);
+            lane = Lane{};
+        }
+        return false;
+    };
+    while (lanes_count < this->lanes && open_lane(lanes_of_loop[lanes_count])) {
+        lanes_count++;
+    }
+
+    while (lanes_count > 0) {
+        // one byte of every lane, their table loads don't depend on each other
+        for (std::size_t k = 0; k < lanes_count;) {
+            Lane &lane = lanes_of_loop[k];
+            int32_t next_state = CompiledDFA::DEAD;
+            if (lane.i < lane.text.size()) {
+                next_state = dfa.next<T>(lane.state, lane.text[lane.i]);
+            }
+            if (next_state >= 0) {
+                int32_t accept_kind = dfa.get_accept_kind(next_state);
+                lane.state = next_state;
+                lane.i++;
+                if (accept_kind != CompiledDFA::NO_TOKEN) {
+                    lane.token_kind = accept_kind;
+                    lane.token_end = lane.i;
+                }
+                ByteRuns::RunKind run = dfa.get_run_kind(next_state);
+                if (run != ByteRuns::NONE) {
+                    const char *data = lane.text.data();
+                    lane.i = dfa.skip_run(next_state, run, data + lane.i, data + lane.text.size()) - data;
+                    if (accept_kind != CompiledDFA::NO_TOKEN) {
+                        lane.token_end = lane.i;
+                    }
+                }
+                k++;
+            } else if (this->finish_token(lane, next_state)) {
+                k++;
+            } else {
+                // the program of the lane is done, the lane takes the next one
+                source.done(lane.buffer);
+                if (open_lane(lane)) {
+                    k++;
+                } else {
+                    // no program left for the lane, the last lane takes its place
+                    lanes_of_loop[k] = lanes_of_loop[--lanes_count];
+                }
+            }
+        }
+    }
+}
+
+bool InterleavedScanner::start_token(Lane &lane) const {
+    const CompiledDFA &dfa = this->lexer->get_dfa();
+    std::string_view text = lane.text;
+    lane.state = dfa.get_entry(lane.mode);
+    if (lane.i < text.size() && ByteRuns::is_white_space(text[lane.i])) {
+        // the white spaces before a token only separate it from the previous one
+        if (dfa.skips_white_space(lane.mode)) {
+            lane.i = ByteRuns::skip(ByteRuns::WHITE_SPACE, text.data() + lane.i, text.data() + text.size())
+                     - text.data();
+        } else {
+            // the mode reads some white spaces, only the others are skipped
+            while (lane.i < text.size() && dfa.next(lane.state, text[lane.i]) == CompiledDFA::SEPARATOR) {
+                lane.i++;
+            }
+        }
+    }
+    lane.token_start = lane.i;
+    lane.token_end = lane.i;
+    lane.token_kind = CompiledDFA::NO_TOKEN;
+    return lane.i < text.size();
+}
+
+bool InterleavedScanner::finish_token(Lane &lane, int32_t next_state) const {
+    const CompiledDFA &dfa = this->lexer->get_dfa();
+    Diagnostics &diagnostics = lane.buffer->diagnostics;
+    if (next_state == CompiledDFA::INVALID && lane.i == lane.token_start) {
+        // this character isn't in the allowed alphabets, it joins the error record of the characters before it
+        diagnostics.add(lane.i, 1);
+        lane.i++;
+    } else if (lane.token_kind == CompiledDFA::NO_TOKEN) {
+        // no prefix was accepted, the first character can't start any token
+        diagnostics.add(lane.token_start, 1);
+        lane.i = lane.token_start + 1;
+    } else {
+        // rewind to the end of the last accepted prefix, the characters read after it start the next token
+        lane.buffer->push_back(Token{lane.token_kind, (uint32_t) lane.token_start,
+                                     (uint32_t) (lane.token_end - lane.token_start)});
+        lane.i = lane.token_end;
+        if (dfa.get_kind_mode(lane.token_kind) != CompiledDFA::KEEP_MODE) {
+            lane.mode = dfa.get_kind_mode(lane.token_kind);
+        }
+    }
+    return this->start_token(lane);
+}
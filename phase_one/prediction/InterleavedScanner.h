@@ -0,0 +1,82 @@
+#ifndef COMPILER_PROJECT_INTERLEAVEDSCANNER_H
+#define COMPILER_PROJECT_INTERLEAVEDSCANNER_H
+
+
+#include <memory>
+#include <string_view>
+#include <vector>
+#include "Lexer.h"
+#include "TokenBuffer.h"
+
+/**
+ * This class scans several programs at once on one thread, one byte of every program in turn.
+ *
+ * Every byte a scanner reads needs the state the byte before it gave, so one scan waits for a table load at
+ * every byte. The scans of different programs don't depend on each other, so reading a byte of each one in the
+ * same loop lets the processor run their loads at the same time. The programs share the table of the lexer,
+ * and every program gets its own tokens, the same ones Lexer::tokenize_all gives.
+ */
+class InterleavedScanner {
+public:
+    // the most programs scanned in the same loop
+    static constexpr std::size_t MAX_LANES = 8;
+
+    /**
+     * The programs a scan takes, one at a time: a lane whose program is done asks for the next one.
+     */
+    class Source {
+    public:
+        virtual ~Source() = default;
+
+        // gives the next program and the buffer its tokens go to, returns false when there is none left.
+        virtual bool next(std::string_view &text, TokenBuffer *&buffer) = 0;
+
+        // called once all the tokens of a program are in its buffer, the text isn't read any more.
+        virtual void done(TokenBuffer *buffer) = 0;
+    };
+
+    // lanes is the number of programs scanned at once, 1 to MAX_LANES
+    InterleavedScanner(std::shared_ptr<const Lexer> lexer, std::size_t lanes);
+
+    /**
+     * Scans the programs, every one from the initial mode, and returns their tokens in the same order.
+     * When a program is done its lane takes the next one.
+     */
+    [[nodiscard]] std::vector<TokenBuffer> tokenize_all(const std::vector<std::string_view> &texts) const;
+
+    /**
+     * Scans every program of the source, every one from the initial mode, until the source has none left.
+     */
+    void tokenize_all(Source &source) const;
+
+private:
+    // the scan of one program
+    struct Lane {
+        std::string_view text{};
+        TokenBuffer *buffer{};
+        std::size_t i{};
+        // the token being scanned, and the checkpoint: the last accepted prefix, its token kind and where it ends
+        std::size_t token_start{};
+        std::size_t token_end{};
+        int32_t token_kind{};
+        int32_t state{};
+        int32_t mode{};
+    };
+
+    std::shared_ptr<const Lexer> lexer{};
+    std::size_t lanes{};
+
+    // scan_all on a table of T cells
+    template<typename T>
+    void scan_all(Source &source) const;
+
+    // skips the white spaces before the next token of a lane, returns false if the program is done
+    bool start_token(Lane &lane) const;
+
+    // ends the token of a lane where the table has no state for the next byte (or at the end of the program),
+    // then starts the next token. Returns false if the program is done.
+    bool finish_token(Lane &lane, int32_t next_state) const;
+};
+
+
+#endif
@@ -0,0 +1,84 @@
+#include <cstring>
+#include <stdexcept>
+#include "LexemeTable.h"
+
+LexemeTable::LexemeTable() {
+    this->slots.assign(1024, NO_ID);
+    this->mask = (uint32_t) this->slots.size() - 1;
+}
+
+uint32_t LexemeTable::intern(std::string_view lexeme) {
+    uint32_t lexeme_hash = hash(lexeme);
+    uint32_t slot = this->find_slot(lexeme, lexeme_hash);
+    if (this->slots[slot] != NO_ID) {
+        return this->slots[slot];
+    }
+
+    if (this->arena.size() + lexeme.size() > UINT32_MAX || this->offsets.size() >= NO_ID) {
+        throw std::runtime_error("Too many lexemes to intern, ids and offsets are 32 bits");
+    }
+    auto id = (uint32_t) this->offsets.size();
+    this->offsets.push_back((uint32_t) this->arena.size());
+    this->lengths.push_back((uint32_t) lexeme.size());
+    this->hashes.push_back(lexeme_hash);
+    this->arena.insert(this->arena.end(), lexeme.begin(), lexeme.end());
+    this->slots[slot] = id;
+
+    // keep the table at most half full, so the probe sequences stay short
+    if (this->offsets.size() * 2 > this->slots.size()) {
+        this->grow();
+    }
+    return id;
+}
+
+uint32_t LexemeTable::find(std::string_view lexeme) const {
+    return this->slots[this->find_slot(lexeme, hash(lexeme))];
+}
+
+std::string_view LexemeTable::get_lexeme(uint32_t id) const {
+    return {this->arena.data() + this->offsets[id], this->lengths[id]};
+}
+
+std::size_t LexemeTable::size() const {
+    return this->offsets.size();
+}
+
+std::size_t LexemeTable::get_arena_size() const {
+    return this->arena.size();
+}
+
+uint32_t LexemeTable::hash(std::string_view lexeme) {
+    uint32_t h = 2166136261u;
+    for (char c: lexeme) {
+        h = (h ^ static_cast<unsigned char>(c)) * 16777619u;
+    }
+    return h;
+}
+
+uint32_t LexemeTable::find_slot(std::string_view lexeme, uint32_t lexeme_hash) const {
+    uint32_t slot = lexeme_hash & this->mask;
+    while (true) {
+        uint32_t id = this->slots[slot];
+        if (id == NO_ID) {
+            return slot;
+        }
+        // the cached hash rejects almost every other lexeme before its bytes are compared
+        if (this->hashes[id] == lexeme_hash && this->lengths[id] == lexeme.size()
+            && std::memcmp(this->arena.data() + this->offsets[id], lexeme.data(), lexeme.size()) == 0) {
+            return slot;
+        }
+        slot = (slot + 1) & this->mask;
+    }
+}
+
+void LexemeTable::grow() {
+    this->slots.assign(this->slots.size() * 2, NO_ID);
+    this->mask = (uint32_t) this->slots.size() - 1;
+    for (uint32_t id = 0; id < this->offsets.size(); id++) {
+        uint32_t slot = this->hashes[id] & this->mask;
+        while (this->slots[slot] != NO_ID) {
+            slot = (slot + 1) & this->mask;
+        }
+        this->slots[slot] = id;
+    }
+}
@@ -0,0 +1,70 @@
+#ifndef COMPILER_PROJECT_LEXEMETABLE_H
+#define COMPILER_PROJECT_LEXEMETABLE_H
+
+
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+/**
+ * This class interns lexemes: every distinct lexeme gets a dense 32 bits id (0, 1, 2...) the first time it is seen,
+ * so later phases compare ids instead of strings and a name repeated all over a program is stored once.
+ *
+ * The lexemes are stored back to back in one byte arena, and looked up with an open addressing hash table
+ * (linear probing) of ids that also caches the hash of every lexeme.
+ */
+class LexemeTable {
+public:
+    // returned by find when a lexeme isn't in the table
+    static constexpr uint32_t NO_ID = UINT32_MAX;
+
+    LexemeTable();
+
+    /**
+     * Returns the id of a lexeme, adding it to the table if it isn't there yet.
+     */
+    uint32_t intern(std::string_view lexeme);
+
+    /**
+     * Returns the id of a lexeme, NO_ID if it was never interned.
+     */
+    [[nodiscard]] uint32_t find(std::string_view lexeme) const;
+
+    /**
+     * Returns the lexeme of an id, the view is only valid until the next call of intern.
+     */
+    [[nodiscard]] std::string_view get_lexeme(uint32_t id) const;
+
+    /**
+     * Returns the number of distinct lexemes.
+     */
+    [[nodiscard]] std::size_t size() const;
+
+    /**
+     * Returns the number of bytes the lexemes take in the arena.
+     */
+    [[nodiscard]] std::size_t get_arena_size() const;
+
+private:
+    // the bytes of all the lexemes, lexeme id is arena[offsets[id], offsets[id] + lengths[id])
+    std::vector<char> arena{};
+    std::vector<uint32_t> offsets{};
+    std::vector<uint32_t> lengths{};
+    std::vector<uint32_t> hashes{};
+
+    // the hash table, every slot is an id or NO_ID if it is empty, its size is a power of two
+    std::vector<uint32_t> slots{};
+    uint32_t mask{};
+
+    // FNV-1a
+    static uint32_t hash(std::string_view lexeme);
+
+    // returns the slot of a lexeme, or the empty slot where it would go
+    [[nodiscard]] uint32_t find_slot(std::string_view lexeme, uint32_t lexeme_hash) const;
+
+    // doubles the hash table and puts every id back in it
+    void grow();
+};
+
+
+#endif
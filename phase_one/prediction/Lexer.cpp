@@ -0,0 +1,266 @@
+#include "Lexer.h"
+
+Lexer::Lexer(std::shared_ptr<Automaton> &a) {
+    this->dfa = std::make_shared<const CompiledDFA>(a, CompiledDFA::find_dead_states(a));
+    if (ShengDFA::is_eligible(*this->dfa)) {
+        this->sheng = std::make_shared<const ShengDFA>(*this->dfa);
+    }
+}
+
+template<typename T>
+bool Lexer::scan_token_as(std::string_view text, std::size_t &position, Token &token, Diagnostics &diagnostics,
+                          int32_t &mode, ScanWindow *window) const {
+    // work on a local copy, so the compiler doesn't have to assume the position aliases the program
+    std::size_t i = position;
+    int32_t current_state = this->dfa->get_entry(mode);
+    while (true) {
+        if (i < text.size() && ByteRuns::is_white_space(text[i])) {
+            // the white spaces before a token only separate it from the previous one
+            if (this->dfa->skips_white_space(mode)) {
+                i = ByteRuns::skip(ByteRuns::WHITE_SPACE, text.data() + i, text.data() + text.size()) - text.data();
+            } else {
+                // the mode reads some white spaces, only the others are skipped
+                while (i < text.size() && this->dfa->next<T>(current_state, text[i]) == CompiledDFA::SEPARATOR) {
+                    i++;
+                }
+            }
+        }
+        if (i < text.size() || window == nullptr) {
+            break;
+        }
+        // the white spaces may run over several windows, none of them is kept
+        bool more = window->fill(i, text);
+        i = 0;
+        if (!more) {
+            position = i;
+            return false;
+        }
+    }
+    std::size_t token_start = i;
+    // the checkpoint: the last accepted prefix, its token kind and where it ends.
+    int32_t token_kind = CompiledDFA::NO_TOKEN;
+    std::size_t token_end = token_start;
+    while (true) {
+        if (i == text.size()) {
+            if (window == nullptr) {
+                break;
+            }
+            // the token goes on in the next window, keep its bytes
+            bool more = window->fill(token_start, text);
+            i -= token_start;
+            token_end -= token_start;
+            token_start = 0;
+            if (!more) {
+                break;
+            }
+        }
+        auto c = static_cast<unsigned char>(text[i]);
+        int32_t next_state = this->dfa->next<T>(current_state, c);
+        if (next_state < 0) {
+            if (next_state == CompiledDFA::INVALID && i == token_start) {
+                // this character isn't in the allowed alphabets, it joins the error record of the characters before it
+                diagnostics.add((window != nullptr ? window->get_base() : 0) + i, 1);
+                position = i + 1;
+                return false;
+            }
+            // next state is a dead state, or a white space or an invalid character ends the token
+            break;
+        }
+
+        // If next state is accepting state
+        int32_t accept_kind = this->dfa->get_accept_kind(next_state);
+        if (accept_kind != CompiledDFA::NO_TOKEN) {
+            token_kind = accept_kind;
+            token_end = i + 1;
+        }
+        current_state = next_state;
+        i++;
+
+        ByteRuns::RunKind run = this->dfa->get_run_kind(current_state);
+        if (run != ByteRuns::NONE) {
+            // the state loops on the whole run, so the run can be skipped at once. If the run goes on in the next
+            // window, the state reads its next byte and loops back here.
+            i = this->dfa->skip_run(current_state, run, text.data() + i, text.data() + text.size()) - text.data();
+            if (accept_kind != CompiledDFA::NO_TOKEN) {
+                token_end = i;
+            }
+        }
+    }
+    std::size_t base = window != nullptr ? window->get_base() : 0;
+    if (token_kind == CompiledDFA::NO_TOKEN) {
+        if (token_start < text.size()) {
+            // no prefix was accepted, the first character can't start any token
+            diagnostics.add(base + token_start, 1);
+            i = token_start + 1;
+        }
+        position = i;
+        return false;
+    }
+    // rewind to the end of the last accepted prefix, the characters read after it start the next token
+    position = token_end;
+    if (this->dfa->get_kind_mode(token_kind) != CompiledDFA::KEEP_MODE) {
+        mode = this->dfa->get_kind_mode(token_kind);
+    }
+    token.kind = token_kind;
+    token.offset = (uint32_t) (base + token_start);
+    token.length = (uint32_t) (token_end - token_start);
+    return true;
+}
+
+bool Lexer::scan_token_shuffled(std::string_view text, std::size_t &position, Token &token,
+                                Diagnostics &diagnostics, int32_t &mode) const {
+#if defined(__SSSE3__)
+    std::size_t i = position;
+    int32_t current_state = this->dfa->get_entry(mode);
+    if (i < text.size() && ByteRuns::is_white_space(text[i])) {
+        if (this->dfa->skips_white_space(mode)) {
+            i = ByteRuns::skip(ByteRuns::WHITE_SPACE, text.data() + i, text.data() + text.size()) - text.data();
+        } else {
+            while (i < text.size() && this->dfa->next<int8_t>(current_state, text[i]) == CompiledDFA::SEPARATOR) {
+                i++;
+            }
+        }
+    }
+    std::size_t token_start = i;
+    int32_t token_kind = CompiledDFA::NO_TOKEN;
+    std::size_t token_end = token_start;
+    if (i < text.size()) {
+        // the first byte goes through the table, it's the only one where an invalid character is an error
+        int32_t state = this->dfa->next<int8_t>(current_state, text[i]);
+        if (state == CompiledDFA::INVALID) {
+            diagnostics.add(i, 1);
+            position = i + 1;
+            return false;
+        }
+        if (state >= 0) {
+            // every byte of states holds the state, the register is the only thing the next shuffle waits for
+            __m128i states = _mm_set1_epi8(static_cast<char>(state));
+            while (true) {
+                int32_t accept_kind = this->dfa->get_accept_kind(state);
+                if (accept_kind != CompiledDFA::NO_TOKEN) {
+                    token_kind = accept_kind;
+                    token_end = i + 1;
+                }
+                i++;
+                ByteRuns::RunKind run = this->dfa->get_run_kind(state);
+                if (run != ByteRuns::NONE) {
+                    i = this->dfa->skip_run(state, run, text.data() + i, text.data() + text.size()) - text.data();
+                    if (accept_kind != CompiledDFA::NO_TOKEN) {
+                        token_end = i;
+                    }
+                }
+                if (i == text.size()) {
+                    break;
+                }
+                states = this->sheng->next(states, text[i]);
+                state = _mm_cvtsi128_si32(states) & 0xFF;
+                if (state == ShengDFA::STOP) {
+                    break;
+                }
+            }
+        }
+    }
+    if (token_kind == CompiledDFA::NO_TOKEN) {
+        if (token_start < text.size()) {
+            diagnostics.add(token_start, 1);
+            i = token_start + 1;
+        }
+        position = i;
+        return false;
+    }
+    position = token_end;
+    if (this->dfa->get_kind_mode(token_kind) != CompiledDFA::KEEP_MODE) {
+        mode = this->dfa->get_kind_mode(token_kind);
+    }
+    token.kind = token_kind;
+    token.offset = (uint32_t) token_start;
+    token.length = (uint32_t) (token_end - token_start);
+    return true;
+#else
+    // no DFA is eligible without SSSE3
+    return this->scan_token_as<int8_t>(text, position, token, diagnostics, mode, nullptr);
+#endif
+}
+
+bool Lexer::scan_token(std::string_view text, std::size_t &position, Token &token, Diagnostics &diagnostics,
+                       int32_t &mode) const {
+    if (this->sheng != nullptr) {
+        return this->scan_token_shuffled(text, position, token, diagnostics, mode);
+    }
+    switch (this->dfa->get_state_bytes()) {
+        case 1:
+            return this->scan_token_as<int8_t>(text, position, token, diagnostics, mode, nullptr);
+        case 2:
+            return this->scan_token_as<int16_t>(text, position, token, diagnostics, mode, nullptr);
+        default:
+            return this->scan_token_as<int32_t>(text, position, token, diagnostics, mode, nullptr);
+    }
+}
+
+bool Lexer::scan_token(std::string_view text, std::size_t &position, Token &token, Diagnostics &diagnostics,
+                       int32_t &mode, ScanWindow &window) const {
+    switch (this->dfa->get_state_bytes()) {
+        case 1:
+            return this->scan_token_as<int8_t>(text, position, token, diagnostics, mode, &window);
+        case 2:
+            return this->scan_token_as<int16_t>(text, position, token, diagnostics, mode, &window);
+        default:
+            return this->scan_token_as<int32_t>(text, position, token, diagnostics, mode, &window);
+    }
+}
+
+TokenBuffer Lexer::tokenize_all(std::string_view text) const {
+    TokenBuffer buffer{};
+    buffer.reserve(text.size() / 8);
+    std::size_t position = 0;
+    int32_t mode = CompiledDFA::INITIAL_MODE;
+    Token token{};
+    while (position < text.size()) {
+        if (this->scan_token(text, position, token, buffer.diagnostics, mode)) {
+            buffer.push_back(token);
+        }
+    }
+    return buffer;
+}
+
+std::vector<uint64_t> Lexer::count_state_visits(std::string_view text) const {
+    std::vector<uint64_t> visits(this->dfa->get_states_count(), 0);
+    Diagnostics diagnostics{};
+    std::size_t position = 0;
+    int32_t mode = CompiledDFA::INITIAL_MODE;
+    Token token{};
+    while (position < text.size()) {
+        int32_t state = this->dfa->get_entry(mode);
+        visits[state]++;
+        if (!this->scan_token(text, position, token, diagnostics, mode)) {
+            continue;
+        }
+        // replay the token like scan_token reads it: up to the byte the table has no state for,
+        // without the runs it skips
+        std::size_t i = token.offset;
+        while (i < text.size()) {
+            state = this->dfa->next(state, text[i++]);
+            if (state < 0) {
+                break;
+            }
+            visits[state]++;
+            ByteRuns::RunKind run = this->dfa->get_run_kind(state);
+            if (run != ByteRuns::NONE) {
+                i = this->dfa->skip_run(state, run, text.data() + i, text.data() + text.size()) - text.data();
+            }
+        }
+    }
+    return visits;
+}
+
+const CompiledDFA &Lexer::get_dfa() const {
+    return *this->dfa;
+}
+
+bool Lexer::uses_shuffle_scanner() const {
+    return this->sheng != nullptr;
+}
+
+const std::string &Lexer::get_kind_name(int32_t kind) const {
+    return this->dfa->get_kind_name(kind);
+}
@@ -0,0 +1,101 @@
+#ifndef COMPILER_PROJECT_LEXER_H
+#define COMPILER_PROJECT_LEXER_H
+
+
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "../automaton/Automaton.h"
+#include "CompiledDFA.h"
+#include "Diagnostics.h"
+#include "ShengDFA.h"
+#include "Token.h"
+#include "TokenBuffer.h"
+
+/**
+ * The input of a scan that isn't all in memory (see StreamScanner): the scan reads it through a window of bytes,
+ * and asks for the next ones when it reaches the end of the window.
+ */
+class ScanWindow {
+public:
+    virtual ~ScanWindow() = default;
+
+    // drops the bytes of the window before keep_from and reads the next bytes after the rest, text becomes the new
+    // window. Returns false if the input is done. The caller moves its indices back by keep_from in both cases.
+    virtual bool fill(std::size_t keep_from, std::string_view &text) = 0;
+
+    // returns the offset of the first byte of the window in the input.
+    [[nodiscard]] virtual std::size_t get_base() const = 0;
+};
+
+/**
+ * The compiled scanner of a set of lexical rules, without any state about a program.
+ * Nothing changes after the constructor, so one lexer can be loaded once and shared by any number of threads,
+ * each one scanning its own program with its own cursor (a Predictor or a StreamScanner).
+ */
+class Lexer {
+public:
+    // the automaton is the final DFA as exported by LexicalRulesHandler::export_automata (tokens already resolved).
+    explicit Lexer(std::shared_ptr<Automaton> &a);
+
+    /**
+     * Scans text from position to the end of one token, returns false if no token was accepted on the way.
+     * The invalid characters skipped on the way are added to diagnostics.
+     * The token starts from the entry state of the lexer mode, and the mode changes if the token enters another one.
+     */
+    bool scan_token(std::string_view text, std::size_t &position, Token &token, Diagnostics &diagnostics,
+                    int32_t &mode) const;
+
+    /**
+     * Same as scan_token, but text is the window of an input that goes on after it: the window is filled when the
+     * scan reaches its end, and position is in the last window. The offsets of the token and of the diagnostics are
+     * offsets in the input. The shuffle scanner doesn't read windows, this scan always reads the table.
+     */
+    bool scan_token(std::string_view text, std::size_t &position, Token &token, Diagnostics &diagnostics,
+                    int32_t &mode, ScanWindow &window) const;
+
+    /**
+     * Scans a whole program into a struct of arrays, starting in the initial mode.
+     */
+    [[nodiscard]] TokenBuffer tokenize_all(std::string_view text) const;
+
+    /**
+     * Counts how many times the scanner reads every state (row) of the table while scanning a program,
+     * the profile LexicalRulesHandler::layout_hot_states orders the states by.
+     */
+    [[nodiscard]] std::vector<uint64_t> count_state_visits(std::string_view text) const;
+
+    /**
+     * Returns the compiled DFA.
+     */
+    [[nodiscard]] const CompiledDFA &get_dfa() const;
+
+    /**
+     * Returns true if the lexer scans with the shuffle scanner (ShengDFA), picked when the lexer is built
+     * if the DFA is small enough.
+     */
+    [[nodiscard]] bool uses_shuffle_scanner() const;
+
+    /**
+     * Returns the name of a token kind.
+     */
+    [[nodiscard]] const std::string &get_kind_name(int32_t kind) const;
+
+private:
+    std::shared_ptr<const CompiledDFA> dfa{};
+    // the masks of the DFA, null if it isn't eligible for the shuffle scanner
+    std::shared_ptr<const ShengDFA> sheng{};
+
+    // scan_token on a table of T cells, window is null if the text is the whole input
+    template<typename T>
+    bool scan_token_as(std::string_view text, std::size_t &position, Token &token, Diagnostics &diagnostics,
+                       int32_t &mode, ScanWindow *window) const;
+
+    // scan_token with the shuffle scanner
+    bool scan_token_shuffled(std::string_view text, std::size_t &position, Token &token, Diagnostics &diagnostics,
+                             int32_t &mode) const;
+};
+
+
+#endif
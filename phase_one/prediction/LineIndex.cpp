@@ -0,0 +1,22 @@
+#include <algorithm>
+#include "LineIndex.h"
+
+LineIndex::LineIndex(std::string_view text) {
+    // about one line every 32 bytes in usual programs
+    this->line_starts.reserve(text.size() / 32 + 1);
+    this->line_starts.push_back(0);
+    const char *begin = text.data();
+    for_each_newline(begin, begin + text.size(), [this, begin](const char *newline) {
+        this->line_starts.push_back((uint32_t) (newline - begin + 1));
+    });
+}
+
+SourcePosition LineIndex::get_position(std::size_t offset) const {
+    // the last line that starts at or before the offset
+    auto it = std::upper_bound(this->line_starts.begin(), this->line_starts.end(), offset) - 1;
+    return SourcePosition{(uint32_t) (it - this->line_starts.begin() + 1), (uint32_t) (offset - *it + 1)};
+}
+
+std::size_t LineIndex::get_lines_count() const {
+    return this->line_starts.size();
+}
@@ -0,0 +1,84 @@
+#ifndef COMPILER_PROJECT_LINEINDEX_H
+#define COMPILER_PROJECT_LINEINDEX_H
+
+
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+#if defined(__AVX2__) || defined(__SSE2__)
+
+#include <immintrin.h>
+
+#endif
+
+/**
+ * A line and a column in a program, both start at 1 (0 means the position isn't known).
+ * The column counts bytes, a tab is one column.
+ */
+struct SourcePosition {
+    uint32_t line{};
+    uint32_t column{};
+};
+
+/**
+ * This class maps offsets of a program to lines and columns.
+ * The scanner only records offsets, the index is built in one vectorized pass over the program the first time
+ * a position is needed (see Predictor::get_position), then every offset costs a binary search over the line starts.
+ */
+class LineIndex {
+public:
+    explicit LineIndex(std::string_view text);
+
+    /**
+     * Returns the line and the column of an offset (an offset past the end is on the last line).
+     */
+    [[nodiscard]] SourcePosition get_position(std::size_t offset) const;
+
+    /**
+     * Returns the number of lines.
+     */
+    [[nodiscard]] std::size_t get_lines_count() const;
+
+    /**
+     * Calls f with a pointer to every '\n' in [p, end), in order, 32 (AVX2) or 16 (SSE2) bytes at a time.
+     */
+    template<typename F>
+    static void for_each_newline(const char *p, const char *end, F f) {
+#if defined(__AVX2__)
+        const __m256i newline = _mm256_set1_epi8('\n');
+        while (end - p >= 32) {
+            __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p));
+            auto mask = (uint32_t) _mm256_movemask_epi8(_mm256_cmpeq_epi8(x, newline));
+            while (mask != 0) {
+                f(p + __builtin_ctz(mask));
+                mask &= mask - 1;
+            }
+            p += 32;
+        }
+#elif defined(__SSE2__)
+        const __m128i newline = _mm_set1_epi8('\n');
+        while (end - p >= 16) {
+            __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+            auto mask = (uint32_t) _mm_movemask_epi8(_mm_cmpeq_epi8(x, newline));
+            while (mask != 0) {
+                f(p + __builtin_ctz(mask));
+                mask &= mask - 1;
+            }
+            p += 16;
+        }
+#endif
+        for (; p < end; p++) {
+            if (*p == '\n') {
+                f(p);
+            }
+        }
+    }
+
+private:
+    // line_starts[i] is the offset of the first byte of line i + 1, sorted
+    std::vector<uint32_t> line_starts{};
+};
+
+
+#endif
@@ -0,0 +1,61 @@
+#include <utility>
+#include "PipelinedTokenStream.h"
+
+PipelinedTokenStream::PipelinedTokenStream(std::shared_ptr<Predictor> predictor, std::size_t capacity)
+        : queue(capacity) {
+    this->predictor = std::move(predictor);
+    this->scanner = std::thread(&PipelinedTokenStream::scan, this);
+}
+
+PipelinedTokenStream::~PipelinedTokenStream() {
+    this->stopped.store(true, std::memory_order_relaxed);
+    this->scanner.join();
+}
+
+void PipelinedTokenStream::scan() {
+    Token token{};
+    while (this->predictor->next_token(token)) {
+        while (!this->queue.try_push(token)) {
+            if (this->stopped.load(std::memory_order_relaxed)) {
+                return;
+            }
+            // the parser is behind, give it the core
+            std::this_thread::yield();
+        }
+    }
+    this->end_token = token;
+    this->queue.close();
+}
+
+bool PipelinedTokenStream::next_token(Token &token) {
+    while (!this->queue.try_pop(token)) {
+        if (this->queue.is_closed()) {
+            // the tokens pushed before the queue was closed are all visible now
+            if (this->queue.try_pop(token)) {
+                return true;
+            }
+            token = this->end_token;
+            return false;
+        }
+        // the scanner is behind, give it the core
+        std::this_thread::yield();
+    }
+    return true;
+}
+
+std::string_view PipelinedTokenStream::get_lexeme(const Token &token) const {
+    return this->predictor->get_lexeme(token);
+}
+
+const std::string &PipelinedTokenStream::get_kind_name(int32_t kind) const {
+    return this->predictor->get_kind_name(kind);
+}
+
+const Diagnostics &PipelinedTokenStream::get_diagnostics() const {
+    return this->predictor->get_diagnostics();
+}
+
+SourcePosition PipelinedTokenStream::get_position(std::size_t offset) {
+    // the scanner never touches the line index, the program is read only
+    return this->predictor->get_position(offset);
+}
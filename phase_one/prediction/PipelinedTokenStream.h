@@ -0,0 +1,56 @@
+#ifndef COMPILER_PROJECT_PIPELINEDTOKENSTREAM_H
+#define COMPILER_PROJECT_PIPELINEDTOKENSTREAM_H
+
+
+#include <atomic>
+#include <memory>
+#include <thread>
+#include "Predictor.h"
+#include "TokenQueue.h"
+
+/**
+ * This class runs a Predictor on its own thread ahead of the parser: the scanner fills a TokenQueue and
+ * next_token drains it, so scanning and parsing overlap on two cores.
+ *
+ * Only a Predictor can be pipelined, its lexemes are views into the whole program so they stay valid while the
+ * scanner goes on (a StreamScanner drops them). The diagnostics are only complete once next_token returned false.
+ */
+class PipelinedTokenStream : public TokenStream {
+public:
+    // the number of tokens the scanner can be ahead of the parser
+    static constexpr std::size_t QUEUE_CAPACITY = 1 << 14;
+
+    explicit PipelinedTokenStream(std::shared_ptr<Predictor> predictor, std::size_t capacity = QUEUE_CAPACITY);
+
+    // stops the scanner if the parser didn't read all the tokens
+    ~PipelinedTokenStream() override;
+
+    PipelinedTokenStream(const PipelinedTokenStream &) = delete;
+
+    PipelinedTokenStream &operator=(const PipelinedTokenStream &) = delete;
+
+    bool next_token(Token &token) override;
+
+    [[nodiscard]] std::string_view get_lexeme(const Token &token) const override;
+
+    [[nodiscard]] const std::string &get_kind_name(int32_t kind) const override;
+
+    [[nodiscard]] const Diagnostics &get_diagnostics() const override;
+
+    SourcePosition get_position(std::size_t offset) override;
+
+private:
+    std::shared_ptr<Predictor> predictor{};
+    TokenQueue queue;
+    // the end of the input token, written by the scanner before it closes the queue
+    Token end_token{};
+    // set when the parser is gone, the scanner stops waiting for room in the queue
+    std::atomic<bool> stopped{};
+    std::thread scanner{};
+
+    // the body of the scanner thread
+    void scan();
+};
+
+
+#endif
@@ -1,112 +1,206 @@
-#include <fstream>
 #include <utility>
 #include <vector>
 #include <algorithm>
-#include <sstream>
-#include <stack>
 #include <limits>
+#include <thread>
 #include "Predictor.h"
 
-Predictor::Predictor(std::shared_ptr<Automaton> &a, const std::map<std::string, int> &priorities,
-                     const std::string &program_text) {
-    this->index = 0;
-    this->program = read_file(program_text);
-    this->automaton = a;
-    this->priorities = priorities;
-
-    find_dead_states();
-
+Predictor::Predictor(std::shared_ptr<Automaton> &a, const std::string &program_text)
+        : Predictor(std::make_shared<const Lexer>(a), program_text) {
 }
 
-// In read_file. i.e. reading the program
-std::string Predictor::read_file(const std::string &file_name) {
-    std::ifstream inFile(file_name);
-    if (!inFile) {
-        throw std::runtime_error("Failed to open file: " + file_name);
+Predictor::Predictor(std::shared_ptr<const Lexer> lexer, const std::string &program_text) {
+    this->index = 0;
+    this->source = std::make_unique<SourceBuffer>(program_text);
+    this->program = this->source->view();
+    if (this->program.size() > std::numeric_limits<uint32_t>::max()) {
+        throw std::runtime_error("Program is too large, token offsets are 32 bits: " + program_text);
     }
+    this->lexer = std::move(lexer);
+}
 
-    // ReadCFG the entire file into a string stream
-    std::stringstream ss;
-    ss << inFile.rdbuf();
+std::pair<std::string, std::string> Predictor::next_token() {
+    Token token{};
+    if (!this->next_token(token)) {
+        // done with the program
+        return std::make_pair("", "");
+    }
+    return std::make_pair(this->get_kind_name(token.kind), std::string(this->get_lexeme(token)));
+}
 
-    // Convert the string stream to a string
-    std::string contents = ss.str();
+bool Predictor::next_token(Token &token) {
+    while (this->index < this->program.size()) {
+        if (this->lexer->scan_token(this->program, this->index, token, this->diagnostics, this->mode)) {
+            return true;
+        }
+    }
+    // done with the program
+    token = Token{};
+    token.offset = (uint32_t) this->index;
+    return false;
+}
 
-    inFile.close();
-    return contents;
+TokenBuffer Predictor::tokenize_all() {
+    return this->scan_all(nullptr);
 }
 
+TokenBuffer Predictor::tokenize_all(LexemeTable &lexemes) {
+    return this->scan_all(&lexemes);
+}
 
-std::pair<std::string, std::string> Predictor::next_token() {
-    std::shared_ptr<State> current_state_ptr = this->automaton->get_start();
-    std::stack<std::pair<std::string, std::string>> token_stack{};
-    std::string token{};
+TokenBuffer Predictor::scan_all(LexemeTable *lexemes) {
+    TokenBuffer buffer{};
+    buffer.reserve((this->program.size() - this->index) / 8);
+    if (lexemes != nullptr) {
+        buffer.lexeme_ids.reserve((this->program.size() - this->index) / 8);
+    }
+    Token token{};
     while (this->index < this->program.size()) {
-        char c = this->program[this->index];
-        if (std::isspace(static_cast<unsigned char>(c))) {
-            index++;
-            break;
-        }
-        if (this->automaton->get_alphabets().find(std::string(1, c)) == this->automaton->get_alphabets().end()) {
-            // this character isn't in the allowed alphabets
-            std::cout << "\033[1;31mError: Invalid input\033[0m" << ", ignoring character:'" << c << "'" << std::endl;
-            index++;
-            continue;
+        if (this->lexer->scan_token(this->program, this->index, token, buffer.diagnostics, this->mode)) {
+            buffer.push_back(token);
+            if (lexemes != nullptr) {
+                buffer.lexeme_ids.push_back(lexemes->intern(this->program.substr(token.offset, token.length)));
+            }
         }
-        // character is appended to the end of the token as we now know that it isn't a space character or end on input.
-        token += std::string(1, c);
-        std::shared_ptr<State> next_state_ptr = *this->automaton->get_next_states(current_state_ptr,
-                                                                                  std::string(1, c)).begin();
-        // If next state is dead state
-        if (this->dead_states.find(next_state_ptr) != this->dead_states.end()) {
-            break;
+    }
+    this->diagnostics.append(buffer.diagnostics);
+    return buffer;
+}
+
+namespace {
+    // the speculative result of scanning one chunk of the program, from its begin as if a token started there.
+    struct ChunkResult {
+        std::size_t begin{};
+        std::size_t end{};
+        TokenBuffer tokens{};
+        // resume[i] is where scanning continues after the i-th token
+        std::vector<std::size_t> resume{};
+        Diagnostics diagnostics{};
+    };
+
+    // chunks smaller than this aren't worth a thread
+    constexpr std::size_t MIN_CHUNK_SIZE = 1 << 16;
+}
+
+TokenBuffer Predictor::tokenize_parallel(unsigned int threads) {
+    std::size_t size = this->program.size() - this->index;
+    std::size_t chunks_count = std::min<std::size_t>(threads, size / MIN_CHUNK_SIZE);
+    if (chunks_count <= 1 || this->lexer->get_dfa().get_modes_count() > 1) {
+        return this->tokenize_all();
+    }
+
+    // split the program, moving every boundary after the next white space: a white space always ends a token,
+    // so the chunks usually start where a token of the sequential scanner starts. If there is no white space
+    // near the boundary it stays where it is, and the stitching below resynchronizes the chunk.
+    const CompiledDFA &dfa = this->lexer->get_dfa();
+    std::vector<std::size_t> boundaries{this->index};
+    for (std::size_t k = 1; k < chunks_count; k++) {
+        std::size_t boundary = this->index + size / chunks_count * k;
+        std::size_t limit = std::min(boundary + MIN_CHUNK_SIZE, this->program.size());
+        for (std::size_t i = boundary; i < limit; i++) {
+            if (dfa.next(dfa.get_start(), this->program[i]) == CompiledDFA::SEPARATOR) {
+                boundary = i + 1;
+                break;
+            }
         }
+        boundaries.push_back(boundary);
+    }
+    boundaries.push_back(this->program.size());
 
-        // If next state is accepting state
-        if (this->automaton->is_accepting_state(next_state_ptr)) {
-            Types::string_set_t tokens = this->automaton->get_tokens(next_state_ptr);
-            int max_priority = std::numeric_limits<int>::min();
-            std::string chosen_token{};
-            for (const std::string &t: tokens) {
-                int new_priority = this->priorities.at(t);
-                if (max_priority < new_priority) {
-                    max_priority = new_priority;
-                    chosen_token = t;
+    // scan every chunk speculatively, each one on its own thread, until it crosses the next boundary
+    std::vector<ChunkResult> results(chunks_count);
+    std::vector<std::thread> workers{};
+    for (std::size_t k = 0; k < chunks_count; k++) {
+        workers.emplace_back([this, k, &boundaries, &results]() {
+            ChunkResult &result = results[k];
+            result.begin = boundaries[k];
+            result.tokens.reserve((boundaries[k + 1] - boundaries[k]) / 8);
+            std::size_t position = boundaries[k];
+            int32_t mode = CompiledDFA::INITIAL_MODE;
+            Token token{};
+            while (position < boundaries[k + 1]) {
+                if (this->lexer->scan_token(this->program, position, token, result.diagnostics, mode)) {
+                    result.tokens.push_back(token);
+                    result.resume.push_back(position);
                 }
             }
-            token_stack.emplace(chosen_token, token);
-        }
-        current_state_ptr = next_state_ptr;
-        this->index++;
+            result.end = position;
+        });
     }
-    if (token_stack.empty()) {
-        if (this->index < this->program.size()) {
-            return this->next_token();
-        }
-        // done with the program
-        return std::make_pair("", "");
+    for (std::thread &worker: workers) {
+        worker.join();
     }
-    return token_stack.top();
-}
-
-void Predictor::find_dead_states() {
-    // Iterate over all states in the automaton
-    for (const std::shared_ptr<State> &state_ptr: this->automaton->get_states()) {
-        // Dead state can't be a start state or an accepting state.
-        if (!this->automaton->is_accepting_state(state_ptr) && this->automaton->get_start() != state_ptr) {
-            // Check if all outgoing transitions lead to the same state
-            bool is_dead_state = true;
-            for (const std::string &symbol: this->automaton->get_alphabets()) {
-                std::shared_ptr<State> next_state_ptr = *this->automaton->get_next_states(state_ptr, symbol).begin();
-                if (next_state_ptr != state_ptr) {
-                    is_dead_state = false;
-                    break;
+
+    // stitch the chunks: a chunk is only valid from the first point where the true scan meets it
+    TokenBuffer buffer{};
+    buffer.reserve(size / 8);
+    std::size_t position = this->index;
+    Token token{};
+    for (ChunkResult &result: results) {
+        std::size_t first_valid = 0;
+        bool synchronized = (position == result.begin);
+        while (!synchronized && position < result.end) {
+            // rescan sequentially until the true position is one the speculative scan resumed from
+            if (this->lexer->scan_token(this->program, position, token, buffer.diagnostics, this->mode)) {
+                buffer.push_back(token);
+                auto it = std::lower_bound(result.resume.begin(), result.resume.end(), position);
+                if (it != result.resume.end() && *it == position) {
+                    first_valid = (it - result.resume.begin()) + 1;
+                    synchronized = true;
                 }
             }
-            // If all transitions lead to the same state, it's a dead state
-            if (is_dead_state) {
-                this->dead_states.insert(state_ptr);
-            }
         }
+        if (!synchronized) {
+            continue;
+        }
+        // the speculative errors before the meeting point were found again by the rescan
+        buffer.diagnostics.append(result.diagnostics, position);
+        for (std::size_t i = first_valid; i < result.tokens.size(); i++) {
+            buffer.kinds.push_back(result.tokens.kinds[i]);
+            buffer.offsets.push_back(result.tokens.offsets[i]);
+            buffer.lengths.push_back(result.tokens.lengths[i]);
+        }
+        position = result.end;
+    }
+    this->index = position;
+    this->diagnostics.append(buffer.diagnostics);
+    return buffer;
+}
+
+int32_t Predictor::get_mode() const {
+    return this->mode;
+}
+
+void Predictor::set_mode(int32_t mode) {
+    if (mode < 0 || mode >= this->lexer->get_dfa().get_modes_count()) {
+        throw std::runtime_error("Unknown lexer mode: " + std::to_string(mode));
     }
-}
\ No newline at end of file
+    this->mode = mode;
+}
+
+std::string_view Predictor::get_program() const {
+    return this->program;
+}
+
+std::string_view Predictor::get_lexeme(const Token &token) const {
+    return this->program.substr(token.offset, token.length);
+}
+
+SourcePosition Predictor::get_position(std::size_t offset) {
+    if (this->lines == nullptr) {
+        this->lines = std::make_unique<LineIndex>(this->program);
+    }
+    return this->lines->get_position(offset);
+}
+
+std::size_t Predictor::get_error_count() const {
+    return this->diagnostics.invalid_count;
+}
+
+const Diagnostics &Predictor::get_diagnostics() const {
+    return this->diagnostics;
+}
+
+const std::string &Predictor::get_kind_name(int32_t kind) const {
+    return this->lexer->get_kind_name(kind);
+}
@@ -2,30 +2,82 @@
 #define COMPILER_PROJECT_PREDICTOR_H
 
 
-#include <map>
+#include <string_view>
 #include "../automaton/Automaton.h"
+#include "Lexer.h"
+#include "LexemeTable.h"
+#include "SourceBuffer.h"
+#include "Token.h"
+#include "TokenBuffer.h"
+#include "TokenStream.h"
 
-class Predictor {
+class Predictor : public TokenStream {
 public:
-    Predictor(std::shared_ptr<Automaton> &a, const std::map<std::string, int> &priorities,
-              const std::string &program_path);
+    // the automaton is the final DFA as exported by LexicalRulesHandler::export_automata (tokens already resolved).
+    Predictor(std::shared_ptr<Automaton> &a, const std::string &program_path);
+
+    // a cursor over one program file that scans with a shared lexer, several predictors can share one lexer
+    // across threads (see BatchTokenizer).
+    Predictor(std::shared_ptr<const Lexer> lexer, const std::string &program_path);
 
     std::pair<std::string, std::string> next_token();
 
-    static std::string read_file(const std::string &file_name);
+    // scans the next token into token without allocating, returns false when the program is done.
+    bool next_token(Token &token) override;
+
+    // scans the rest of the program in one loop into a struct of arrays, invalid characters are only recorded.
+    TokenBuffer tokenize_all();
+
+    // same as tokenize_all, and interns the lexeme of every token into lexemes as it goes (see TokenBuffer::lexeme_ids).
+    TokenBuffer tokenize_all(LexemeTable &lexemes);
+
+    // same as tokenize_all, but the program is split into chunks that are scanned speculatively on several threads
+    // and stitched back together, the result is the same as tokenize_all.
+    // A chunk can't know the lexer mode it starts in, so rules with modes are scanned sequentially.
+    TokenBuffer tokenize_parallel(unsigned int threads);
+
+    // returns the lexer mode the next token is scanned in.
+    [[nodiscard]] int32_t get_mode() const;
+
+    // switches the lexer mode of the next token (e.g. the parser enters an embedded language).
+    void set_mode(int32_t mode);
 
-    void find_dead_states();
+    // returns the bytes of the program.
+    [[nodiscard]] std::string_view get_program() const;
+
+    // returns the lexeme of a token, it is a view into the program.
+    [[nodiscard]] std::string_view get_lexeme(const Token &token) const override;
+
+    // returns the name of a token kind.
+    [[nodiscard]] const std::string &get_kind_name(int32_t kind) const override;
+
+    // returns the number of invalid characters skipped so far.
+    [[nodiscard]] std::size_t get_error_count() const;
+
+    // returns the line and the column of an offset, the line index is built the first time it is called.
+    SourcePosition get_position(std::size_t offset) override;
+
+    // returns the runs of invalid characters skipped so far.
+    [[nodiscard]] const Diagnostics &get_diagnostics() const override;
 
 
 
 private:
-    std::shared_ptr<Automaton> automaton{};
-    std::vector<std::vector<std::shared_ptr<State>>> matrix{};
-    std::map<std::string, int> priorities{};
-    std::vector<std::string> symbols{};
-    Types::state_set_t dead_states{};
-    std::string program{};
-    int index{};
+    // the compiled final DFA, it is what next_token walks on. It is never changed, so it can be shared.
+    std::shared_ptr<const Lexer> lexer{};
+    // the program file, mapped or read, and a view of its bytes.
+    std::unique_ptr<SourceBuffer> source{};
+    std::string_view program{};
+    // the start of every line of the program, only built when a position is needed.
+    std::unique_ptr<LineIndex> lines{};
+    std::size_t index{};
+    // the lexer mode the next token is scanned in
+    int32_t mode{CompiledDFA::INITIAL_MODE};
+    // the invalid characters skipped so far, tokenize_all and tokenize_parallel also return theirs in the buffer.
+    Diagnostics diagnostics{};
+
+    // the loop of tokenize_all, lexemes may be nullptr.
+    TokenBuffer scan_all(LexemeTable *lexemes);
 };
 
 
@@ -0,0 +1,33 @@
+#include <algorithm>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include "ShengDFA.h"
+
+bool ShengDFA::is_eligible([[maybe_unused]] const CompiledDFA &dfa) {
+#if defined(__SSSE3__)
+    return dfa.get_states_count() <= MAX_STATES;
+#else
+    return false;
+#endif
+}
+
+ShengDFA::ShengDFA(const CompiledDFA &dfa) {
+    if (dfa.get_states_count() > MAX_STATES) {
+        throw std::runtime_error("DFA has too many states for the shuffle scanner: "
+                                 + std::to_string(dfa.get_states_count()));
+    }
+    this->masks.assign(dfa.get_classes_count(), Mask{});
+    for (Mask &mask: this->masks) {
+        // the lanes after the last state are never read, they stop like the STOP lane
+        std::fill(std::begin(mask.lanes), std::end(mask.lanes), STOP);
+    }
+    for (int c = 0; c < 256; c++) {
+        uint8_t byte_class = dfa.get_byte_class(c);
+        this->byte_classes[c] = byte_class;
+        for (int32_t state = 0; state < dfa.get_states_count(); state++) {
+            int32_t next_state = dfa.next(state, c);
+            this->masks[byte_class].lanes[state] = next_state < 0 ? STOP : (uint8_t) next_state;
+        }
+    }
+}
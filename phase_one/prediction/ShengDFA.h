@@ -0,0 +1,66 @@
+#ifndef COMPILER_PROJECT_SHENGDFA_H
+#define COMPILER_PROJECT_SHENGDFA_H
+
+
+#include <cstdint>
+#include <vector>
+#include "CompiledDFA.h"
+
+#if defined(__SSSE3__)
+
+#include <immintrin.h>
+
+#endif
+
+/**
+ * The transitions of a CompiledDFA of at most MAX_STATES states as one 16 byte shuffle mask per byte class,
+ * the shuffle scanner of Lexer (in the style of Hyperscan's Sheng).
+ *
+ * Byte s of the mask of a class is the state the class leads to from state s, so a pshufb of the mask by a
+ * register holding the current state gives the next state. The state never leaves the register: the mask only
+ * depends on the byte, so a byte costs one shuffle on the critical path instead of a table load.
+ * All the negative sentinels of the table become the STOP state, which leads to itself: the scanner handles the
+ * first byte of a token with the table, the only one where the sentinels differ.
+ *
+ * The shuffle needs SSSE3 (see the COMPILER_PROJECT_SSSE3 option), without it no DFA is eligible.
+ * Eligibility is checked on the final DFA of the lexer, the per-token DFAs it is built from are never scanned.
+ */
+class ShengDFA {
+public:
+    // the most states of an eligible DFA, the 16th byte of a mask is the STOP state
+    static constexpr int32_t MAX_STATES = 15;
+    // the state the sentinels of the table lead to
+    static constexpr uint8_t STOP = MAX_STATES;
+
+    /**
+     * Returns true if the DFA fits in the masks and the shuffle scanner was built.
+     */
+    static bool is_eligible(const CompiledDFA &dfa);
+
+    // the DFA must be eligible
+    explicit ShengDFA(const CompiledDFA &dfa);
+
+#if defined(__SSSE3__)
+
+    /**
+     * Returns the next state of every byte of states (all of them hold the current state) using a byte.
+     */
+    [[nodiscard]] inline __m128i next(__m128i states, unsigned char c) const {
+        const Mask &mask = this->masks[this->byte_classes[c]];
+        return _mm_shuffle_epi8(_mm_load_si128(reinterpret_cast<const __m128i *>(mask.lanes)), states);
+    }
+
+#endif
+
+private:
+    struct alignas(16) Mask {
+        uint8_t lanes[16];
+    };
+
+    // a mask for every byte class
+    std::vector<Mask> masks{};
+    uint8_t byte_classes[256]{};
+};
+
+
+#endif
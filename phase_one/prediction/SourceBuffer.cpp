@@ -0,0 +1,72 @@
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "SourceBuffer.h"
+
+SourceBuffer::SourceBuffer(const std::string &file_name) {
+    int fd = open(file_name.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw std::runtime_error("Failed to open file: " + file_name);
+    }
+
+    struct stat file_stat{};
+    if (fstat(fd, &file_stat) == 0 && S_ISREG(file_stat.st_mode) && file_stat.st_size > 0) {
+        void *address = mmap(nullptr, file_stat.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (address != MAP_FAILED) {
+            this->mapping = address;
+            this->mapping_size = file_stat.st_size;
+            // the scanner reads the program once from start to end
+            madvise(this->mapping, this->mapping_size, MADV_SEQUENTIAL);
+            madvise(this->mapping, this->mapping_size, MADV_WILLNEED);
+            close(fd);
+            return;
+        }
+    }
+
+    // pipes and files that can't be mapped are read the usual way
+    try {
+        read_all(fd, file_name);
+    } catch (...) {
+        close(fd);
+        throw;
+    }
+    close(fd);
+}
+
+SourceBuffer::~SourceBuffer() {
+    if (this->mapping != nullptr) {
+        munmap(this->mapping, this->mapping_size);
+    }
+}
+
+void SourceBuffer::read_all(int fd, const std::string &file_name) {
+    char block[1 << 16];
+    while (true) {
+        ssize_t count = read(fd, block, sizeof(block));
+        if (count == 0) {
+            break;
+        }
+        if (count < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            throw std::runtime_error("Failed to read file: " + file_name + " (" + std::strerror(errno) + ")");
+        }
+        this->contents.append(block, count);
+    }
+}
+
+std::string_view SourceBuffer::view() const {
+    if (this->mapping != nullptr) {
+        return {static_cast<const char *>(this->mapping), this->mapping_size};
+    }
+    return this->contents;
+}
+
+bool SourceBuffer::is_mapped() const {
+    return this->mapping != nullptr;
+}
@@ -0,0 +1,49 @@
+#ifndef COMPILER_PROJECT_SOURCEBUFFER_H
+#define COMPILER_PROJECT_SOURCEBUFFER_H
+
+
+#include <string>
+#include <string_view>
+
+/**
+ * This class holds the bytes of a program that the scanner reads in place.
+ * A regular file is memory mapped (read only, with a sequential access hint) so it is never copied,
+ * anything that can't be mapped (pipes, character devices, empty files) is read into an owned buffer instead.
+ */
+class SourceBuffer {
+public:
+    /**
+     * Opens a program file, throws std::runtime_error if the file can't be opened or read.
+     */
+    explicit SourceBuffer(const std::string &file_name);
+
+    ~SourceBuffer();
+
+    SourceBuffer(const SourceBuffer &) = delete;
+
+    SourceBuffer &operator=(const SourceBuffer &) = delete;
+
+    /**
+     * Returns the bytes of the program.
+     */
+    [[nodiscard]] std::string_view view() const;
+
+    /**
+     * Returns whether the program is memory mapped (false when it was read into memory).
+     */
+    [[nodiscard]] bool is_mapped() const;
+
+private:
+    // the mapping when the file is mapped
+    void *mapping{};
+    std::size_t mapping_size{};
+
+    // the contents when the file is read
+    std::string contents{};
+
+    // reads a file descriptor until its end into contents
+    void read_all(int fd, const std::string &file_name);
+};
+
+
+#endif
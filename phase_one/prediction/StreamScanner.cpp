@@ -0,0 +1,93 @@
+#include <cstring>
+#include <string>
+#include <utility>
+#include "StreamScanner.h"
+
+StreamScanner::StreamScanner(std::shared_ptr<Automaton> &a, std::istream &in, std::size_t block_size)
+        : StreamScanner(std::make_shared<const Lexer>(a), in, block_size) {
+}
+
+StreamScanner::StreamScanner(std::shared_ptr<const Lexer> lexer, std::istream &in, std::size_t block_size) : in(in) {
+    this->lexer = std::move(lexer);
+    this->block_size = block_size;
+}
+
+bool StreamScanner::next_token(Token &token) {
+    while (this->position < this->size || !this->end_of_stream) {
+        std::string_view text(this->buffer.data(), this->size);
+        if (this->lexer->scan_token(text, this->position, token, this->diagnostics, this->mode, *this)) {
+            return true;
+        }
+    }
+    // done with the stream
+    token = Token{};
+    token.offset = (uint32_t) (this->base + this->size);
+    return false;
+}
+
+bool StreamScanner::fill(std::size_t keep_from, std::string_view &text) {
+    LineIndex::for_each_newline(this->buffer.data(), this->buffer.data() + keep_from, [this](const char *newline) {
+        this->newlines_before_base++;
+        this->line_start = this->base + (newline - this->buffer.data()) + 1;
+    });
+    std::memmove(this->buffer.data(), this->buffer.data() + keep_from, this->size - keep_from);
+    this->size -= keep_from;
+    this->base += keep_from;
+    bool more = false;
+    if (!this->end_of_stream) {
+        if (this->buffer.size() < this->size + this->block_size) {
+            // the kept token is longer than the free space, the window grows to fit it
+            this->buffer.resize(this->size + this->block_size);
+        }
+        // wait for the next byte, then only take the bytes the stream already has: a whole block could keep
+        // the tokens of a slow pipe waiting for bytes that come much later
+        char *free = this->buffer.data() + this->size;
+        std::size_t count = 0;
+        if (this->in.peek() != std::char_traits<char>::eof()) {
+            count = (std::size_t) this->in.readsome(free, (std::streamsize) this->block_size);
+            if (count == 0) {
+                // the stream doesn't tell what it has (std::cin synchronized with stdio), take the byte peek read
+                this->in.read(free, 1);
+                count = (std::size_t) this->in.gcount();
+            }
+        }
+        this->size += count;
+        this->end_of_stream = (count == 0);
+        more = (count != 0);
+    }
+    text = std::string_view(this->buffer.data(), this->size);
+    return more;
+}
+
+std::size_t StreamScanner::get_base() const {
+    return this->base;
+}
+
+std::string_view StreamScanner::get_lexeme(const Token &token) const {
+    // offsets wrap around at 2^32, so is the difference
+    uint32_t index = token.offset - (uint32_t) this->base;
+    return {this->buffer.data() + index, token.length};
+}
+
+const std::string &StreamScanner::get_kind_name(int32_t kind) const {
+    return this->lexer->get_kind_name(kind);
+}
+
+const Diagnostics &StreamScanner::get_diagnostics() const {
+    return this->diagnostics;
+}
+
+SourcePosition StreamScanner::get_position(std::size_t offset) {
+    // offsets wrap around at 2^32, so is the difference
+    uint32_t index = (uint32_t) offset - (uint32_t) this->base;
+    if (index > this->size) {
+        return SourcePosition{};
+    }
+    std::size_t newlines = this->newlines_before_base;
+    std::size_t start = this->line_start;
+    LineIndex::for_each_newline(this->buffer.data(), this->buffer.data() + index, [&](const char *newline) {
+        newlines++;
+        start = this->base + (newline - this->buffer.data()) + 1;
+    });
+    return SourcePosition{(uint32_t) (newlines + 1), (uint32_t) (this->base + index - start + 1)};
+}
@@ -0,0 +1,73 @@
+#ifndef COMPILER_PROJECT_STREAMSCANNER_H
+#define COMPILER_PROJECT_STREAMSCANNER_H
+
+
+#include <istream>
+#include <memory>
+#include <vector>
+#include "../automaton/Automaton.h"
+#include "Lexer.h"
+#include "TokenStream.h"
+
+/**
+ * This class scans a program from a std::istream (stdin, a pipe, a socket...) without reading it all first.
+ * The stream is read into a window that only keeps the bytes of the token being scanned, at most a block at a time
+ * and only the bytes the stream already has, so the memory used is a block plus the longest token whatever the size
+ * of the input, and a slow pipe gets every token as soon as its bytes come.
+ *
+ * The scan is the one of Lexer::scan_token, the scanner is the window it reads. The tokens are the same as the ones
+ * of Predictor. Their offsets are offsets in the stream (modulo 2^32),
+ * and a lexeme is only kept until the next call of next_token.
+ * The newlines of the bytes dropped from the window are counted, so the positions of the last tokens are known.
+ */
+class StreamScanner : public TokenStream, private ScanWindow {
+public:
+    // the size of the blocks read from the stream
+    static constexpr std::size_t BLOCK_SIZE = 1 << 16;
+
+    // the automaton is the final DFA as exported by LexicalRulesHandler::export_automata (tokens already resolved).
+    StreamScanner(std::shared_ptr<Automaton> &a, std::istream &in, std::size_t block_size = BLOCK_SIZE);
+
+    // a cursor over a stream that scans with a shared lexer.
+    StreamScanner(std::shared_ptr<const Lexer> lexer, std::istream &in, std::size_t block_size = BLOCK_SIZE);
+
+    bool next_token(Token &token) override;
+
+    [[nodiscard]] std::string_view get_lexeme(const Token &token) const override;
+
+    [[nodiscard]] const std::string &get_kind_name(int32_t kind) const override;
+
+    [[nodiscard]] const Diagnostics &get_diagnostics() const override;
+
+    // only the offsets still in the window are known (the last token and after it).
+    SourcePosition get_position(std::size_t offset) override;
+
+private:
+    std::shared_ptr<const Lexer> lexer{};
+    std::istream &in;
+    std::size_t block_size{};
+
+    // the window: buffer[0, size) are the bytes at [base, base + size) of the stream
+    std::vector<char> buffer{};
+    std::size_t size{};
+    std::size_t base{};
+    // where the next token is scanned from in the window
+    std::size_t position{};
+    // the lexer mode the next token is scanned in
+    int32_t mode{CompiledDFA::INITIAL_MODE};
+    bool end_of_stream{};
+    // the lines dropped from the window: how many newlines and where the line at base starts in the stream
+    std::size_t newlines_before_base{};
+    std::size_t line_start{};
+
+    Diagnostics diagnostics{};
+
+    // drops the bytes of the window before keep_from (they move to the front) and reads what the stream has after
+    // the rest (at most a block, waiting for one byte at least), returns false if the stream is done.
+    bool fill(std::size_t keep_from, std::string_view &text) override;
+
+    [[nodiscard]] std::size_t get_base() const override;
+};
+
+
+#endif
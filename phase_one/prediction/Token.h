@@ -0,0 +1,22 @@
+#ifndef COMPILER_PROJECT_TOKEN_H
+#define COMPILER_PROJECT_TOKEN_H
+
+
+#include <cstdint>
+
+/**
+ * A token produced by the scanner.
+ * The token doesn't own its lexeme, the lexeme is the span [offset, offset + length) of the program buffer,
+ * and the kind is an id that the scanner can turn back into the token name.
+ */
+struct Token {
+    // the kind of the token returned after the end of the input.
+    static constexpr int32_t END_OF_INPUT = -1;
+
+    int32_t kind{END_OF_INPUT};
+    uint32_t offset{};
+    uint32_t length{};
+};
+
+
+#endif
@@ -0,0 +1,47 @@
+#ifndef COMPILER_PROJECT_TOKENBUFFER_H
+#define COMPILER_PROJECT_TOKENBUFFER_H
+
+
+#include <cstddef>
+#include <vector>
+#include "Diagnostics.h"
+#include "Token.h"
+
+/**
+ * The tokens of a whole program stored as a struct of arrays.
+ * The i-th token is (kinds[i], offsets[i], lengths[i]), so a phase that only needs the kinds reads one contiguous array.
+ */
+struct TokenBuffer {
+    std::vector<int32_t> kinds{};
+    std::vector<uint32_t> offsets{};
+    std::vector<uint32_t> lengths{};
+
+    // lexeme_ids[i] is the interned lexeme of the i-th token, empty unless the buffer was scanned with a LexemeTable
+    std::vector<uint32_t> lexeme_ids{};
+
+    // the invalid characters skipped while scanning
+    Diagnostics diagnostics{};
+
+    [[nodiscard]] std::size_t size() const {
+        return this->kinds.size();
+    }
+
+    [[nodiscard]] Token at(std::size_t i) const {
+        return Token{this->kinds[i], this->offsets[i], this->lengths[i]};
+    }
+
+    void push_back(const Token &token) {
+        this->kinds.push_back(token.kind);
+        this->offsets.push_back(token.offset);
+        this->lengths.push_back(token.length);
+    }
+
+    void reserve(std::size_t capacity) {
+        this->kinds.reserve(capacity);
+        this->offsets.reserve(capacity);
+        this->lengths.reserve(capacity);
+    }
+};
+
+
+#endif
@@ -0,0 +1,85 @@
+#ifndef COMPILER_PROJECT_TOKENQUEUE_H
+#define COMPILER_PROJECT_TOKENQUEUE_H
+
+
+#include <atomic>
+#include <cstddef>
+#include <vector>
+#include "Token.h"
+
+/**
+ * A bounded lock free queue of tokens between one producer thread (the scanner) and one consumer thread (the parser).
+ *
+ * The slots are a ring indexed by two ever growing counters, the consumer only writes head and the producer only
+ * writes tail. Each side keeps its own cached copy of the other side's counter on its own cache line, and only
+ * reloads it (an acquire load of a line the other core owns) when the ring looks empty or full.
+ */
+class TokenQueue {
+public:
+    static constexpr std::size_t CACHE_LINE_SIZE = 64;
+
+    // the capacity is rounded up to a power of two
+    explicit TokenQueue(std::size_t capacity) {
+        std::size_t size = 1;
+        while (size < capacity) {
+            size <<= 1;
+        }
+        this->slots.resize(size);
+        this->mask = size - 1;
+    }
+
+    // producer side: adds a token, returns false if the queue is full.
+    bool try_push(const Token &token) {
+        std::size_t current_tail = this->tail.load(std::memory_order_relaxed);
+        if (current_tail - this->cached_head == this->slots.size()) {
+            this->cached_head = this->head.load(std::memory_order_acquire);
+            if (current_tail - this->cached_head == this->slots.size()) {
+                return false;
+            }
+        }
+        this->slots[current_tail & this->mask] = token;
+        this->tail.store(current_tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    // consumer side: takes the oldest token, returns false if the queue is empty.
+    bool try_pop(Token &token) {
+        std::size_t current_head = this->head.load(std::memory_order_relaxed);
+        if (current_head == this->cached_tail) {
+            this->cached_tail = this->tail.load(std::memory_order_acquire);
+            if (current_head == this->cached_tail) {
+                return false;
+            }
+        }
+        token = this->slots[current_head & this->mask];
+        this->head.store(current_head + 1, std::memory_order_release);
+        return true;
+    }
+
+    // producer side: no token will be pushed any more.
+    void close() {
+        this->closed.store(true, std::memory_order_release);
+    }
+
+    // consumer side: once this is true, every token was pushed and try_pop sees them all.
+    [[nodiscard]] bool is_closed() const {
+        return this->closed.load(std::memory_order_acquire);
+    }
+
+private:
+    std::vector<Token> slots{};
+    std::size_t mask{};
+
+    // written by the consumer
+    alignas(CACHE_LINE_SIZE) std::atomic<std::size_t> head{};
+    std::size_t cached_tail{};
+
+    // written by the producer
+    alignas(CACHE_LINE_SIZE) std::atomic<std::size_t> tail{};
+    std::size_t cached_head{};
+
+    alignas(CACHE_LINE_SIZE) std::atomic<bool> closed{};
+};
+
+
+#endif
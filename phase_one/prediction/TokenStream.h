@@ -0,0 +1,36 @@
+#ifndef COMPILER_PROJECT_TOKENSTREAM_H
+#define COMPILER_PROJECT_TOKENSTREAM_H
+
+
+#include <string>
+#include <string_view>
+#include "Diagnostics.h"
+#include "LineIndex.h"
+#include "Token.h"
+
+/**
+ * A source of tokens the parser reads one at a time, a Predictor over a whole program or a StreamScanner over a stream.
+ */
+class TokenStream {
+public:
+    virtual ~TokenStream() = default;
+
+    // scans the next token into token, returns false when the input is done.
+    virtual bool next_token(Token &token) = 0;
+
+    // returns the lexeme of a token, StreamScanner only keeps the lexeme of the last token it returned.
+    [[nodiscard]] virtual std::string_view get_lexeme(const Token &token) const = 0;
+
+    // returns the name of a token kind.
+    [[nodiscard]] virtual const std::string &get_kind_name(int32_t kind) const = 0;
+
+    // returns the runs of invalid characters skipped so far.
+    [[nodiscard]] virtual const Diagnostics &get_diagnostics() const = 0;
+
+    // returns the line and the column of an offset, (0, 0) if it isn't known any more.
+    // the end of the input token is at the offset of the end of the input.
+    virtual SourcePosition get_position(std::size_t offset) = 0;
+};
+
+
+#endif
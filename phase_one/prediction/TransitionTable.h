@@ -0,0 +1,87 @@
+#ifndef COMPILER_PROJECT_TRANSITIONTABLE_H
+#define COMPILER_PROJECT_TRANSITIONTABLE_H
+
+
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <vector>
+
+// allocates on cache line boundaries
+template<typename T>
+struct CacheLineAllocator {
+    static constexpr std::size_t CACHE_LINE_SIZE = 64;
+
+    using value_type = T;
+
+    CacheLineAllocator() = default;
+
+    template<typename U>
+    explicit CacheLineAllocator(const CacheLineAllocator<U> &) {}
+
+    T *allocate(std::size_t n) {
+        return static_cast<T *>(::operator new(n * sizeof(T), std::align_val_t(CACHE_LINE_SIZE)));
+    }
+
+    void deallocate(T *p, std::size_t) {
+        ::operator delete(p, std::align_val_t(CACHE_LINE_SIZE));
+    }
+
+    bool operator==(const CacheLineAllocator &) const {
+        return true;
+    }
+
+    bool operator!=(const CacheLineAllocator &) const {
+        return false;
+    }
+};
+
+/**
+ * The [state][class] transitions of a CompiledDFA, stored with T cells (int8_t, int16_t or int32_t).
+ * The cells are signed so the sentinels of CompiledDFA stay negative, a narrower type only fits fewer states.
+ *
+ * Every row starts on a cache line: the table is allocated on a cache line boundary and the rows are padded to a
+ * whole number of lines, so reading a state never loads the lines of two rows.
+ */
+template<typename T>
+class TransitionTable {
+public:
+    TransitionTable() = default;
+
+    /**
+     * Copies a row major [state][class] table, every cell must fit in T.
+     */
+    TransitionTable(const std::vector<int32_t> &table, int32_t states_count, int32_t classes_count) {
+        std::size_t cells_per_line = CacheLineAllocator<T>::CACHE_LINE_SIZE / sizeof(T);
+        this->row_size = (classes_count + cells_per_line - 1) / cells_per_line * cells_per_line;
+        this->cells.assign(static_cast<std::size_t>(states_count) * this->row_size, 0);
+        for (int32_t state = 0; state < states_count; state++) {
+            for (int32_t byte_class = 0; byte_class < classes_count; byte_class++) {
+                this->cells[state * this->row_size + byte_class] =
+                        static_cast<T>(table[static_cast<std::size_t>(state) * classes_count + byte_class]);
+            }
+        }
+    }
+
+    /**
+     * Returns the next state (or a negative sentinel) from a state using a byte class.
+     */
+    [[nodiscard]] inline int32_t next(int32_t state, uint8_t byte_class) const {
+        return this->cells[static_cast<std::size_t>(state) * this->row_size + byte_class];
+    }
+
+    /**
+     * Returns the size of the table in bytes, padding included.
+     */
+    [[nodiscard]] std::size_t get_size_bytes() const {
+        return this->cells.size() * sizeof(T);
+    }
+
+private:
+    std::vector<T, CacheLineAllocator<T>> cells{};
+    // the cells of a row, padding included
+    std::size_t row_size{};
+};
+
+
+#endif
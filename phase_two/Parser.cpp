@@ -6,20 +6,31 @@
 // Constructor
 Parser::Parser(const std::shared_ptr<Table> &table) {
     this->table = table;
+    this->dollar_symbol = this->table->get_rules()->get_dollar_symbol();
 }
 
 // Parse the input using the table
-void Parser::parse(std::vector<std::string> tokens) {
+void Parser::parse(const TokenBuffer &tokens, const std::shared_ptr<TokenStream> &tokenizer) {
     std::stack<std::string> parseStack{};
     parseStack.emplace(this->table->get_rules()->get_dollar_symbol());
     parseStack.push(table->get_start_symbol());
-    tokens.push_back(this->table->get_rules()->get_dollar_symbol());
 
-    int tokenIndex = 0;
+    std::size_t tokenIndex = 0;
+    // past the last token, the input is the dollar symbol
+    auto symbol_at = [&](std::size_t i) -> const std::string & {
+        return (i < tokens.size()) ? tokenizer->get_kind_name(tokens.kinds[i]) : this->dollar_symbol;
+    };
+    // past the last token, the input is at the end of the last token
+    auto location_at = [&](std::size_t i) -> std::string {
+        if (i < tokens.size()) {
+            return get_location(tokenizer, tokens.offsets[i]);
+        }
+        return tokens.size() == 0 ? "" : get_location(tokenizer, tokens.offsets.back() + tokens.lengths.back());
+    };
 
     std::string top = parseStack.top();
     parseStack.pop();
-    std::string input_symbol = tokens[tokenIndex];
+    std::string input_symbol = symbol_at(tokenIndex);
 
     std::cout << "######################### parsing started #########################" << '\n';
 
@@ -33,10 +44,11 @@ void Parser::parse(std::vector<std::string> tokens) {
                     std::cout << GREEN << "Matched (" << top << ", " << input_symbol << ")" << RESET << '\n';
                     top = parseStack.top();
                     parseStack.pop();
-                    input_symbol = tokens[++tokenIndex];
+                    input_symbol = symbol_at(++tokenIndex);
                 }
             } else {
-                std::cout << RED << "Error: missing {" << top << "}. Inserted " << RESET << '\n';
+                std::cout << RED << "Error: missing {" << top << "}. Inserted" << location_at(tokenIndex) << RESET
+                          << '\n';
                 top = parseStack.top();
                 parseStack.pop();
             }
@@ -45,7 +57,7 @@ void Parser::parse(std::vector<std::string> tokens) {
             if (!rule.empty()) {
                 if ((rule.size() == 1) && (rule[0] == this->table->get_rules()->get_sync_symbol())) {
                     // sync
-                    std::cout << RED << "Error: sync" << RESET << '\n';
+                    std::cout << RED << "Error: sync" << location_at(tokenIndex) << RESET << '\n';
                     top = parseStack.top();
                     parseStack.pop();
                 } else {
@@ -71,8 +83,9 @@ void Parser::parse(std::vector<std::string> tokens) {
                     }
                 }
             } else {
-                std::cout << RED << "Error: ignoring {" << input_symbol << "}" << RESET << '\n';
-                input_symbol = tokens[++tokenIndex];
+                std::cout << RED << "Error: ignoring {" << input_symbol << "}" << location_at(tokenIndex) << RESET
+                          << '\n';
+                input_symbol = symbol_at(++tokenIndex);
             }
         }
     }
@@ -84,7 +97,7 @@ void Parser::parse(std::vector<std::string> tokens) {
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 // New version of the parser.
 
-void Parser::parse(const std::shared_ptr<Predictor> &tokenizer, const std::string &parsing_tree_path,
+void Parser::parse(const std::shared_ptr<TokenStream> &tokenizer, const std::string &parsing_tree_path,
                    const std::string &parsing_output_path) {
     std::stack<std::string> parseStack{};
     parseStack.emplace(this->table->get_rules()->get_dollar_symbol());
@@ -92,37 +105,42 @@ void Parser::parse(const std::shared_ptr<Predictor> &tokenizer, const std::strin
 
     std::string top = parseStack.top();
     parseStack.pop();
-    std::pair<std::string, std::string> input_symbol = get_next_token(tokenizer);
+    Token input_token = get_next_token(tokenizer);
     std::cout << "######################### parsing started #########################" << '\n';
     while (!parseStack.empty()) {
         if (table->is_terminal(top)) {
-            if (top == input_symbol.first) {
+            if (top == get_terminal(tokenizer, input_token)) {
                 if (top == this->table->get_rules()->get_dollar_symbol()) {
                     output_string(parsing_output_path, "Parsing successful");
                     std::cout << GREEN << "Parsing successful" << RESET << '\n';
                     break;
                 } else {
-                    output_string(parsing_output_path, "Matched (" + top + ", " + input_symbol.second + ")");
-                    std::cout << GREEN << "Matched (" << top << ", " << input_symbol.second << ")" << RESET << '\n';
+                    output_string(parsing_output_path,
+                                  "Matched (" + top + ", " + std::string(get_lexeme(tokenizer, input_token)) + ")");
+                    std::cout << GREEN << "Matched (" << top << ", " << get_lexeme(tokenizer, input_token) << ")" << RESET
+                              << '\n';
                     top = parseStack.top();
                     parseStack.pop();
-                    input_symbol = get_next_token(tokenizer);
+                    input_token = get_next_token(tokenizer);
                 }
             } else {
-                output_string(parsing_output_path, "Error: missing {" + top + "}. Inserted ");
-                std::cout << RED << "Error: missing {" << top << "}. Inserted " << RESET << '\n';
+                std::string location = get_location(tokenizer, input_token.offset);
+                output_string(parsing_output_path, "Error: missing {" + top + "}. Inserted" + location);
+                std::cout << RED << "Error: missing {" << top << "}. Inserted" << location << RESET << '\n';
                 top = parseStack.top();
                 parseStack.pop();
             }
         } else {
-            std::vector<std::string> rule = table->get_rule(top, input_symbol.first);
+            std::vector<std::string> rule = table->get_rule(top, get_terminal(tokenizer, input_token));
             if (!rule.empty()) {
                 if ((rule.size() == 1) && (rule[0] == this->table->get_rules()->get_sync_symbol())) {
                     // sync
+                    std::string location = get_location(tokenizer, input_token.offset);
                     output_string(parsing_output_path,
-                                  "Error: " + this->table->get_rules()->get_sync_symbol() + " {" + top + "}");
+                                  "Error: " + this->table->get_rules()->get_sync_symbol() + " {" + top + "}" +
+                                  location);
                     std::cout << RED << "Error: " << this->table->get_rules()->get_sync_symbol()
-                              << " {" << RESET << top << RED << "}"
+                              << " {" << RESET << top << RED << "}" << location
                               << RESET << '\n';
                     top = parseStack.top();
                     parseStack.pop();
@@ -150,22 +168,44 @@ void Parser::parse(const std::shared_ptr<Predictor> &tokenizer, const std::strin
                     }
                 }
             } else {
-                output_string(parsing_output_path, "Error: ignoring " + input_symbol.first + " {" + input_symbol.second + "}");
-                std::cout << RED << "Error: ignoring " << input_symbol.first << " {" << RESET << input_symbol.second
-                          << RED << "}" << RESET << '\n';
-                input_symbol = get_next_token(tokenizer);
+                std::string location = get_location(tokenizer, input_token.offset);
+                output_string(parsing_output_path, "Error: ignoring " + get_terminal(tokenizer, input_token) + " {" +
+                                                   std::string(get_lexeme(tokenizer, input_token)) + "}" + location);
+                std::cout << RED << "Error: ignoring " << get_terminal(tokenizer, input_token) << " {" << RESET
+                          << get_lexeme(tokenizer, input_token) << RED << "}" << location << RESET << '\n';
+                input_token = get_next_token(tokenizer);
             }
         }
     }
     std::cout << "########################### parsing ended #########################" << '\n';
 }
 
-std::pair<std::string, std::string> Parser::get_next_token(const std::shared_ptr<Predictor> &tokenizer) {
-    std::pair<std::string, std::string> entry = tokenizer->next_token();
-    if (entry.first.empty() && entry.second.empty()) {
-        return {this->table->get_rules()->get_dollar_symbol(), this->table->get_rules()->get_dollar_symbol()};
+Token Parser::get_next_token(const std::shared_ptr<TokenStream> &tokenizer) {
+    Token token{};
+    tokenizer->next_token(token);
+    return token;
+}
+
+const std::string &Parser::get_terminal(const std::shared_ptr<TokenStream> &tokenizer, const Token &token) {
+    if (token.kind == Token::END_OF_INPUT) {
+        return this->dollar_symbol;
+    }
+    return tokenizer->get_kind_name(token.kind);
+}
+
+std::string_view Parser::get_lexeme(const std::shared_ptr<TokenStream> &tokenizer, const Token &token) {
+    if (token.kind == Token::END_OF_INPUT) {
+        return this->dollar_symbol;
+    }
+    return tokenizer->get_lexeme(token);
+}
+
+std::string Parser::get_location(const std::shared_ptr<TokenStream> &tokenizer, std::size_t offset) {
+    SourcePosition position = tokenizer->get_position(offset);
+    if (position.line == 0) {
+        return "";
     }
-    return entry;
+    return " at line " + std::to_string(position.line) + ", column " + std::to_string(position.column);
 }
 
 void Parser::output_string(const std::string &parsing_output_path, const std::string &output_string) {
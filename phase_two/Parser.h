@@ -2,23 +2,34 @@
 #define COMPILER_PROJECT_PARSER_H
 
 #include <stack>
+#include <string_view>
 #include <vector>
 #include "Table.h"
-#include "../phase_one/prediction/Predictor.h"
+#include "../phase_one/prediction/TokenBuffer.h"
+#include "../phase_one/prediction/TokenStream.h"
 
 
 class Parser {
 public:
     explicit Parser(const std::shared_ptr<Table> &table);
 
-    void parse(std::vector<std::string> tokens);
+    void parse(const TokenBuffer &tokens, const std::shared_ptr<TokenStream> &tokenizer);
 
-    void parse(const std::shared_ptr<Predictor> &tokenizer, const std::string &parsing_tree_path,
+    void parse(const std::shared_ptr<TokenStream> &tokenizer, const std::string &parsing_tree_path,
                const std::string &parsing_output_path);
 
     static void output_string(const std::string &parsing_output_path, const std::string &output_string);
 
-    std::pair<std::string, std::string> get_next_token(const std::shared_ptr<Predictor> &tokenizer);
+    Token get_next_token(const std::shared_ptr<TokenStream> &tokenizer);
+
+    // returns the terminal a token stands for, the dollar symbol for the end of the input.
+    const std::string &get_terminal(const std::shared_ptr<TokenStream> &tokenizer, const Token &token);
+
+    // returns the lexeme of a token, the dollar symbol for the end of the input.
+    std::string_view get_lexeme(const std::shared_ptr<TokenStream> &tokenizer, const Token &token);
+
+    // returns " at line l, column c" for an offset of the input, empty if the position isn't known.
+    static std::string get_location(const std::shared_ptr<TokenStream> &tokenizer, std::size_t offset);
 
 private:
     // ANSI escape codes
@@ -27,6 +38,7 @@ private:
     const std::string RESET = "\033[0m";
 
     std::shared_ptr<Table> table;
+    std::string dollar_symbol{};
     std::vector<std::pair<std::string, std::vector<std::string>>> parse_tree_vector{};
 };
 
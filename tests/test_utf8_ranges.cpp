@@ -0,0 +1,202 @@
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+#include "../phase_one/automaton/Automaton.h"
+#include "../phase_one/automaton/Conversions.h"
+#include "../phase_one/creation/Utf8Ranges.h"
+
+/**
+ * Checks the range splitter of Utf8Ranges, the Unicode atoms of the rules and the minimization of their DFAs.
+ * Prints every failed check and exits with 1 if there is one.
+ */
+
+namespace {
+    int failures = 0;
+
+    void check(bool condition, const std::string &what) {
+        if (!condition) {
+            std::cerr << "FAILED: " << what << '\n';
+            failures++;
+        }
+    }
+
+    std::string hex(uint32_t code_point) {
+        char text[16];
+        std::snprintf(text, sizeof(text), "%X", code_point);
+        return text;
+    }
+
+    // decodes a byte string the splitter matches, returns false if it isn't the shortest encoding of a code point
+    bool decode(const std::string &bytes, uint32_t &code_point) {
+        auto lead = static_cast<unsigned char>(bytes[0]);
+        std::size_t length = lead < 0x80 ? 1 : lead < 0xE0 ? 2 : lead < 0xF0 ? 3 : 4;
+        if (length != bytes.size()) {
+            return false;
+        }
+        code_point = length == 1 ? lead : lead & (0x7F >> length);
+        for (std::size_t i = 1; i < length; i++) {
+            code_point = (code_point << 6) | (static_cast<unsigned char>(bytes[i]) & 0x3F);
+        }
+        std::string encoding{};
+        Utf8Ranges::encode(code_point, encoding);
+        return encoding == bytes;
+    }
+
+    // appends every byte string a sequence matches
+    void expand(const Utf8Ranges::ByteSequence &sequence, std::size_t i, std::string &prefix,
+                std::vector<std::string> &out) {
+        if (i == sequence.size()) {
+            out.push_back(prefix);
+            return;
+        }
+        for (unsigned int byte = sequence[i].first; byte <= sequence[i].second; byte++) {
+            prefix.push_back(static_cast<char>(byte));
+            expand(sequence, i + 1, prefix, out);
+            prefix.pop_back();
+        }
+    }
+
+    bool is_surrogate(uint32_t code_point) {
+        return code_point >= 0xD800 && code_point <= 0xDFFF;
+    }
+
+    // the sequences of [low, high] match the encoding of every code point of the range but the surrogates, once
+    void check_split(uint32_t low, uint32_t high) {
+        std::string range = "[" + hex(low) + ", " + hex(high) + "]";
+        std::vector<std::string> encodings{};
+        for (const Utf8Ranges::ByteSequence &sequence: Utf8Ranges::split(low, high)) {
+            std::string prefix{};
+            expand(sequence, 0, prefix, encodings);
+        }
+        std::vector<bool> seen(high - low + 1, false);
+        for (const std::string &encoding: encodings) {
+            uint32_t code_point = 0;
+            if (!decode(encoding, code_point) || code_point < low || code_point > high || is_surrogate(code_point)) {
+                check(false, range + " matches a byte string outside the range");
+                return;
+            }
+            check(!seen[code_point - low], range + " matches " + hex(code_point) + " twice");
+            seen[code_point - low] = true;
+        }
+        for (uint32_t code_point = low; code_point <= high; code_point++) {
+            if (!is_surrogate(code_point) && !seen[code_point - low]) {
+                check(false, range + " misses " + hex(code_point));
+                return;
+            }
+        }
+    }
+
+    // walks a DFA over the bytes of text. The states are compared by id: the minimization gives them new ids in
+    // place, so the hashes of the sets and maps that hold them are stale.
+    bool accepts(const std::shared_ptr<Automaton> &dfa, const std::string &text) {
+        int state = dfa->get_start()->getId();
+        for (char c: text) {
+            int next = -1;
+            for (const auto &[key, to]: dfa->get_transitions()) {
+                if (key.first->getId() == state && key.second == std::string(1, c) && !to.empty()) {
+                    next = (*to.begin())->getId();
+                }
+            }
+            if (next < 0) {
+                return false;
+            }
+            state = next;
+        }
+        for (const std::shared_ptr<State> &accepting: dfa->get_accepting_states()) {
+            if (accepting->getId() == state) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void check_split_boundaries() {
+        check_split(0, Utf8Ranges::MAX_CODE_POINT);
+        // every length of encoding ends here
+        check_split(0x7F, 0x80);
+        check_split(0x7FF, 0x800);
+        check_split(0xFFFF, 0x10000);
+        check_split(0x10FFFF, 0x10FFFF);
+        check_split(0x70, 0x10010);
+        // the trailing 6-bit groups of the endpoints aren't full
+        check_split(0x3F, 0x41);
+        check_split(0x801, 0xFFE);
+        check_split(0x10001, 0x10FFFE);
+        // surrogates are skipped
+        check_split(0xD7FF, 0xE000);
+        check(Utf8Ranges::split(0xD800, 0xDFFF).empty(), "[D800, DFFF] has no encoding");
+    }
+
+    void check_mixed_endpoints() {
+        // an ASCII character and a code point, or two code points written in both ways
+        std::vector<std::pair<std::string, std::pair<uint32_t, uint32_t>>> rules = {
+                {"a-\\u{ff}",       {0x61, 0xFF}},
+                {"\\u{20}-~",       {0x20, 0x7E}},
+                {"\\u{3b1}-\u03c9", {0x3B1, 0x3C9}},
+                {"\u00e0-\\u{ff}",  {0xE0, 0xFF}},
+        };
+        for (const auto &[rule_text, range]: rules) {
+            std::string rule = rule_text;
+            std::unordered_map<char, Utf8Ranges::Fragment> fragments = Utf8Ranges::extract(rule, "\\L");
+            check(fragments.size() == 1 && rule.size() == 1, rule_text + " is one atom");
+            if (fragments.size() != 1) {
+                continue;
+            }
+            const Utf8Ranges::Fragment &fragment = fragments.begin()->second;
+            check(fragment.text == rule_text, rule_text + " keeps its text");
+            for (uint32_t code_point = range.first - 1; code_point <= range.second + 1; code_point++) {
+                std::string encoding{};
+                Utf8Ranges::encode(code_point, encoding);
+                bool inside = code_point >= range.first && code_point <= range.second;
+                check(accepts(fragment.automaton, encoding) == inside,
+                      rule_text + (inside ? " rejects " : " accepts ") + hex(code_point));
+            }
+        }
+        // ASCII ranges are left to the parser
+        std::string rule = "a-z";
+        check(Utf8Ranges::extract(rule, "\\L").empty() && rule == "a-z", "a-z has no atom");
+    }
+
+    // two states that reach the same groups on different symbols aren't equivalent: 1 accepts "a" and 2 accepts "b",
+    // so the DFA accepts "aa" and "bb" only
+    void check_minimization() {
+        auto dfa = std::make_shared<Automaton>();
+        dfa->set_epsilon_symbol("\\L");
+        std::vector<std::shared_ptr<State>> states{};
+        for (int id = 0; id < 5; id++) {
+            states.push_back(std::make_shared<State>(id, id == 3, id == 3 ? "t" : ""));
+            dfa->add_state(states.back());
+        }
+        dfa->set_start(states[0]);
+        dfa->add_accepting_state(states[3]);
+        dfa->add_alphabet("a");
+        dfa->add_alphabet("b");
+        int transitions[5][2] = {{1, 2}, {3, 4}, {4, 3}, {4, 4}, {4, 4}};
+        for (int id = 0; id < 5; id++) {
+            dfa->add_transitions(states[id], "a", {states[transitions[id][0]]});
+            dfa->add_transitions(states[id], "b", {states[transitions[id][1]]});
+        }
+
+        Conversions conversions{};
+        std::shared_ptr<Automaton> minimized = conversions.minimizeDFA(dfa);
+        for (const std::string &text: {"aa", "bb"}) {
+            check(accepts(minimized, text), "the minimized DFA rejects " + text);
+        }
+        for (const std::string &text: {"", "a", "b", "ab", "ba", "aab"}) {
+            check(!accepts(minimized, text), "the minimized DFA accepts \"" + text + "\"");
+        }
+    }
+}
+
+int main() {
+    check_split_boundaries();
+    check_mixed_endpoints();
+    check_minimization();
+    if (failures != 0) {
+        std::cerr << failures << " checks failed\n";
+        return 1;
+    }
+    std::cout << "all checks passed\n";
+    return 0;
+}